@@ -1,4 +1,4 @@
-QT       += core gui
+QT       += core gui concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -9,14 +9,38 @@ CONFIG += c++11
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    batchcompiler.cpp \
+    cfg.cpp \
+    charscan.cpp \
+    compiler.cpp \
+    lexer.cpp \
+    lspserver.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    profiler.cpp \
+    ssa.cpp \
+    symboltable.cpp \
+    tokenhighlighter.cpp \
+    tokenstream.cpp \
+    workstealingpool.cpp
 
 HEADERS += \
+    batchcompiler.h \
+    cfg.h \
+    charscan.h \
+    compiler.h \
+    lexer.h \
+    lspserver.h \
     mainwindow.h \
+    profiler.h \
+    ssa.h \
+    symboltable.h \
     token.h \
+    tokenhighlighter.h \
+    tokenstream.h \
     treeNode.h \
-    triad.h
+    triad.h \
+    workstealingpool.h
 
 FORMS += \
     mainwindow.ui
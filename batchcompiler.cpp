@@ -0,0 +1,68 @@
+#include "batchcompiler.h"
+#include "compiler.h"
+#include "workstealingpool.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+
+int BatchResult::failedCount() const
+{
+    int failed = 0;
+    for (const BatchEntry &entry : entries) {
+        if (!entry.readable || !entry.parsed) {
+            failed++;
+        }
+    }
+    return failed;
+}
+
+QStringList BatchCompiler::collectFiles(const QString &directory, const QStringList &filters)
+{
+    QStringList fileNames;
+    QDirIterator it(directory, filters, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        fileNames.append(it.next());
+    }
+    fileNames.sort();
+    return fileNames;
+}
+
+BatchResult BatchCompiler::compile(const QStringList &fileNames) const
+{
+    BatchResult result;
+    result.entries.resize(fileNames.size());
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Каждое задание пишет только в свою запись, поэтому синхронизация не нужна
+    WorkStealingPool pool(threads);
+    BatchEntry *entries = result.entries.data();
+    pool.run(fileNames.size(), [&fileNames, entries](int index) {
+        BatchEntry &entry = entries[index];
+        entry.fileName = fileNames[index];
+
+        QElapsedTimer fileTimer;
+        fileTimer.start();
+
+        QFile file(entry.fileName);
+        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            entry.readable = true;
+
+            // Таблица лексем и SSA-листинг в отчёт не попадают
+            Compiler compiler;
+            CompileResult compiled = compiler.compile(QString::fromUtf8(file.readAll()), true, false);
+            entry.parsed = compiled.parsed;
+            entry.syntaxError = compiled.syntaxError;
+            entry.triadCount = compiled.optimizedTriads.size();
+        }
+
+        entry.elapsedNs = fileTimer.nsecsElapsed();
+    });
+
+    result.threads = pool.threadCount();
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
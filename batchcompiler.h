@@ -0,0 +1,45 @@
+#ifndef BATCHCOMPILER_H
+#define BATCHCOMPILER_H
+
+#include "token.h"
+
+#include <QStringList>
+#include <QVector>
+
+struct BatchEntry {
+    QString fileName;
+    bool readable;
+    bool parsed;
+    Token syntaxError;
+    int triadCount;            // После удаления лишних триад
+    qint64 elapsedNs;          // Чтение и полный цикл трансляции файла
+
+    BatchEntry() : readable(false), parsed(false), triadCount(0), elapsedNs(0) {}
+};
+
+struct BatchResult {
+    QVector<BatchEntry> entries;
+    int threads;
+    qint64 elapsedMs;
+
+    BatchResult() : threads(0), elapsedMs(0) {}
+
+    int failedCount() const;
+};
+
+// Независимая трансляция множества файлов: каждый файл — отдельное задание
+// пула с перехватом работы со своим экземпляром Compiler
+class BatchCompiler {
+public:
+    explicit BatchCompiler(int threads = 0) : threads(threads) {}
+
+    static QStringList collectFiles(const QString &directory, const QStringList &filters);
+
+    // Файлы транслируются в заданном порядке: явный список или результат collectFiles
+    BatchResult compile(const QStringList &fileNames) const;
+
+private:
+    int threads;
+};
+
+#endif // BATCHCOMPILER_H
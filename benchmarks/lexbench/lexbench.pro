@@ -0,0 +1,21 @@
+QT       += core
+QT       -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = lexbench
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../charscan.cpp \
+    ../../lexer.cpp \
+    ../../symboltable.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../charscan.h \
+    ../../lexer.h \
+    ../../symboltable.h \
+    ../../token.h
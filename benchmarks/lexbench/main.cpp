@@ -0,0 +1,240 @@
+#include "charscan.h"
+#include "lexer.h"
+#include "symboltable.h"
+#include "token.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QTextStream>
+
+// Сравнение скорости лексического анализа: прежний анализатор на регулярных
+// выражениях против Lexer с каждым из векторных ядер CharScan.
+//
+//   lexbench [файл] [повторы]
+//
+// Без файла разбирается сгенерированный текст (~8 МБ). Ядро CharScan
+// выбирается один раз на процесс, поэтому для scalar/sse2/avx2 программа
+// запускает саму себя с нужным TRANSLATOR_SIMD и ключом --kernel.
+
+namespace {
+
+const int DefaultRepeats = 5;
+const int GeneratedLines = 200000;
+
+// Лексический анализ из первой версии MainWindow::lexicalAnalysis без заполнения таблицы
+QList<Token> regexLexicalAnalysis(const QString &text)
+{
+    QStringList lines = text.split('\n');
+
+    QList<Token> tokens;
+
+    QRegularExpression identifierRegex(R"(^[a-zA-Z_][a-zA-Z0-9_]*)");
+    QRegularExpression numberRegex(R"(^\d+)");
+    QRegularExpression stringRegex(R"(^"[^"]*")");
+    QRegularExpression operatorRegex(R"(^(\+\+|--))");
+    QRegularExpression comparisonRegex(R"(^[<>=])");
+    QRegularExpression assignmentRegex(R"(^:=)");
+    QRegularExpression specialCharRegex(R"(^[\(\)\{\};])");
+    QStringList keywords = {"for", "do"};
+
+    for (int i = 0; i < lines.size(); ++i) {
+        QString line = lines[i];
+        int column = 0;
+
+        while (column < line.length()) {
+            QStringRef subLine = line.midRef(column).trimmed();
+
+            if (subLine.startsWith("//")) {
+                break;
+            }
+
+            if (line[column].isSpace()) {
+                column++;
+                continue;
+            }
+
+            bool keywordMatched = false;
+            for (const QString &keyword : keywords) {
+                if (subLine.startsWith(keyword) &&
+                    (subLine.size() == keyword.length() || !subLine[keyword.length()].isLetterOrNumber())) {
+                    tokens.append({Keyword, keyword, i + 1, column + 1});
+                    column += keyword.length();
+                    keywordMatched = true;
+                    break;
+                }
+            }
+            if (keywordMatched) {
+                continue;
+            }
+
+            const QRegularExpression *regexes[] = {&stringRegex, &assignmentRegex, &operatorRegex,
+                                                   &comparisonRegex, &numberRegex, &identifierRegex,
+                                                   &specialCharRegex};
+            const TokenType types[] = {StringConstant, Assignment, Operator, Comparison, Number, Identifier, SpecialChar};
+
+            bool matched = false;
+            for (int k = 0; k < 7 && !matched; ++k) {
+                QRegularExpressionMatch match = regexes[k]->match(line.mid(column));
+                if (match.hasMatch()) {
+                    QString tokenValue = match.captured();
+                    TokenType type = types[k] == Identifier && keywords.contains(tokenValue) ? Keyword : types[k];
+                    tokens.append({type, tokenValue, i + 1, column + 1});
+                    column += match.capturedLength();
+                    matched = true;
+                }
+            }
+            if (matched) {
+                continue;
+            }
+
+            tokens.append({Error, QString("Неопознанный символ: %1").arg(line[column]), i + 1, column + 1});
+            column++;
+        }
+    }
+
+    return tokens;
+}
+
+int lexerTokenCount(const QString &text)
+{
+    SymbolTable symbols;
+    Lexer lexer(text, symbols);
+    Token token;
+    int count = 0;
+    while (lexer.next(token)) {
+        count++;
+    }
+    return count;
+}
+
+QString generateText()
+{
+    QString text;
+    QTextStream out(&text);
+    for (int i = 0; i < GeneratedLines; ++i) {
+        switch (i % 4) {
+        case 0:
+            out << "counter_" << i % 97 << " := value_" << i % 13 << " := " << i << ";\n";
+            break;
+        case 1:
+            out << "for (index := 0; index < " << i << "; index++) do total := \"step\";\n";
+            break;
+        case 2:
+            out << "    // комментарий к строке " << i << "\n";
+            break;
+        default:
+            out << "\tname := \"строковая константа " << i << "\" ;   \n";
+            break;
+        }
+    }
+    out.flush();
+    return text;
+}
+
+void report(QTextStream &out, const QString &name, const QString &text, int tokens, qint64 bestNs)
+{
+    const double megabytes = text.length() * sizeof(QChar) / (1024.0 * 1024.0);
+    const double seconds = qMax<qint64>(1, bestNs) / 1e9;
+    out << QString("%1 %2 мс  %3 МБ/с  %4 млн лексем/с  (%5 лексем)")
+           .arg(name, -8)
+           .arg(bestNs / 1e6, 9, 'f', 2)
+           .arg(megabytes / seconds, 8, 'f', 1)
+           .arg(tokens / seconds / 1e6, 7, 'f', 2)
+           .arg(tokens)
+        << "\n";
+    out.flush();
+}
+
+template <typename Function>
+qint64 bestOf(int repeats, int &tokens, Function function)
+{
+    qint64 best = -1;
+    QElapsedTimer timer;
+    for (int i = 0; i < repeats; ++i) {
+        timer.start();
+        tokens = function();
+        const qint64 elapsed = timer.nsecsElapsed();
+        if (best < 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList arguments = app.arguments();
+    arguments.removeFirst();
+
+    const bool kernelOnly = arguments.removeAll("--kernel") > 0;
+    QString fileName = arguments.value(0);
+    const int repeats = qMax(1, arguments.value(1, QString::number(DefaultRepeats)).toInt());
+
+    QTextStream out(stdout);
+    QString text;
+    if (fileName.isEmpty()) {
+        text = generateText();
+    } else {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            QTextStream(stderr) << "Не удалось открыть " << fileName << "\n";
+            return 1;
+        }
+        // Как и в самом приложении, исходный текст читается в UTF-8 независимо от локали
+        text = QString::fromUtf8(file.readAll());
+    }
+
+    int tokens = 0;
+    if (kernelOnly) {
+        const qint64 best = bestOf(repeats, tokens, [&text]() { return lexerTokenCount(text); });
+        report(out, CharScan::isaName(CharScan::activeIsa()), text, tokens, best);
+        return 0;
+    }
+
+    out << QString("Текст: %1 символов, %2 повторов, лучшее время").arg(text.length()).arg(repeats) << "\n";
+
+    const qint64 best = bestOf(repeats, tokens, [&text]() { return regexLexicalAnalysis(text).size(); });
+    report(out, "regex", text, tokens, best);
+    out.flush();
+
+    // Сгенерированный текст передаётся дочернему процессу через файл, чтобы все ядра разбирали одно и то же
+    QString input = fileName;
+    if (input.isEmpty()) {
+        input = QCoreApplication::applicationDirPath() + "/lexbench-input.txt";
+        QFile file(input);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+            QTextStream(stderr) << "Не удалось записать " << input << "\n";
+            return 1;
+        }
+        file.write(text.toUtf8());
+    }
+
+    const char *kernels[] = {"scalar", "sse2", ""};
+    for (const char *kernel : kernels) {
+        QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+        environment.remove("TRANSLATOR_SIMD");
+        if (*kernel) {
+            environment.insert("TRANSLATOR_SIMD", kernel);
+        }
+
+        QProcess process;
+        process.setProcessEnvironment(environment);
+        process.setProcessChannelMode(QProcess::ForwardedChannels);
+        process.start(QCoreApplication::applicationFilePath(),
+                      QStringList() << "--kernel" << input << QString::number(repeats));
+        process.waitForFinished(-1);
+    }
+
+    if (fileName.isEmpty()) {
+        QFile::remove(input);
+    }
+    return 0;
+}
@@ -0,0 +1,246 @@
+#include "cfg.h"
+
+#include <algorithm>
+
+ControlFlowGraph::ControlFlowGraph(const QVector<Triad> &triads, const QVector<TriadLoop> &loops)
+{
+    int maxIndex = 0;
+    for (const Triad &triad : triads) {
+        maxIndex = qMax(maxIndex, triad.index);
+    }
+
+    QVector<int> positionOf(maxIndex + 1, -1);
+    for (int i = 0; i < triads.size(); ++i) {
+        if (triads[i].index > 0) {
+            positionOf[triads[i].index] = i;
+        }
+    }
+
+    loopsAt.resize(triads.size());
+    for (const TriadLoop &loop : loops) {
+        if (loop.begin < 1 || loop.end > maxIndex || loop.condition < loop.begin || loop.condition > maxIndex ||
+            loop.body > loop.end || loop.body <= loop.condition) {
+            continue;
+        }
+
+        LoopRange range;
+        range.begin = positionOf[loop.begin];
+        range.condition = positionOf[loop.condition];
+        range.body = positionOf[loop.body];
+        range.end = positionOf[loop.end];
+        if (range.begin < 0 || range.condition < 0 || range.body < 0 || range.end < 0) {
+            continue;
+        }
+
+        loopsAt[range.begin].append(loopRanges.size());
+        loopRanges.append(range);
+    }
+
+    for (QVector<int> &starting : loopsAt) {
+        std::sort(starting.begin(), starting.end(), [this](int a, int b) {
+            return loopRanges[a].end > loopRanges[b].end;
+        });
+    }
+
+    build(0, triads.size(), newBlock());
+
+    computeOrder();
+    computeDominators();
+}
+
+bool ControlFlowGraph::dominates(int a, int b) const
+{
+    if (preorder[a] < 0 || preorder[b] < 0) {
+        return false;
+    }
+    return preorder[a] <= preorder[b] && postorder[b] <= postorder[a];
+}
+
+QVector<QVector<int> > ControlFlowGraph::dominanceFrontiers() const
+{
+    QVector<QVector<int> > frontiers(blockList.size());
+
+    for (int block = 0; block < blockList.size(); ++block) {
+        const QVector<int> &predecessors = blockList[block].predecessors;
+        if (predecessors.size() < 2 || idom[block] < 0) {
+            continue;
+        }
+
+        for (int predecessor : predecessors) {
+            if (idom[predecessor] < 0) {
+                continue;
+            }
+            for (int runner = predecessor; runner != idom[block]; runner = idom[runner]) {
+                if (frontiers[runner].isEmpty() || frontiers[runner].last() != block) {
+                    frontiers[runner].append(block);
+                }
+            }
+        }
+    }
+
+    return frontiers;
+}
+
+int ControlFlowGraph::newBlock()
+{
+    blockList.append(BasicBlock());
+    return blockList.size() - 1;
+}
+
+void ControlFlowGraph::addEdge(int from, int to)
+{
+    blockList[from].successors.append(to);
+    blockList[to].predecessors.append(from);
+}
+
+int ControlFlowGraph::build(int from, int to, int block)
+{
+    int position = from;
+    while (position < to) {
+        int loop = -1;
+        for (int candidate : loopsAt[position]) {
+            if (loopRanges[candidate].end < to) {
+                loop = candidate;
+                break;
+            }
+        }
+
+        if (loop < 0) {
+            blockList[block].triads.append(position++);
+            continue;
+        }
+
+        const LoopRange range = loopRanges[loop];
+
+        block = build(range.begin, range.condition, block);
+
+        int header = newBlock();
+        blockList[header].loopHeader = true;
+        blockList[header].triads.append(range.condition);
+        addEdge(block, header);
+
+        int bodyEntry = newBlock();
+        addEdge(header, bodyEntry);
+        int latch = build(range.body, range.end, bodyEntry);
+        latch = build(range.condition + 1, range.body, latch);
+        blockList[latch].triads.append(range.end);
+        addEdge(latch, header);
+
+        block = newBlock();
+        addEdge(header, block);
+        position = range.end + 1;
+    }
+    return block;
+}
+
+void ControlFlowGraph::computeOrder()
+{
+    const int count = blockList.size();
+    QVector<int> postorderList;
+    QVector<bool> visited(count, false);
+    QVector<QPair<int, int> > stack;
+
+    visited[entry()] = true;
+    stack.append(qMakePair(entry(), 0));
+    while (!stack.isEmpty()) {
+        const int block = stack.last().first;
+        const QVector<int> &successors = blockList[block].successors;
+        const int next = stack.last().second++;
+
+        // Обход последователей с конца, чтобы тело цикла шло в порядке раньше выхода из него
+        if (next < successors.size()) {
+            int successor = successors[successors.size() - 1 - next];
+            if (!visited[successor]) {
+                visited[successor] = true;
+                stack.append(qMakePair(successor, 0));
+            }
+        } else {
+            postorderList.append(block);
+            stack.removeLast();
+        }
+    }
+
+    rpo.clear();
+    rpoNumber.fill(-1, count);
+    for (int i = postorderList.size() - 1; i >= 0; --i) {
+        rpoNumber[postorderList[i]] = rpo.size();
+        rpo.append(postorderList[i]);
+    }
+}
+
+void ControlFlowGraph::computeDominators()
+{
+    const int count = blockList.size();
+
+    // Cooper, Harvey, Kennedy: итерации в обратном постпорядке, для графов
+    // из вложенных циклов сходятся за два-три прохода
+    idom.fill(-1, count);
+    idom[entry()] = entry();
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 1; i < rpo.size(); ++i) {
+            const int block = rpo[i];
+            int newIdom = -1;
+            for (int predecessor : blockList[block].predecessors) {
+                if (idom[predecessor] < 0) {
+                    continue;
+                }
+                if (newIdom < 0) {
+                    newIdom = predecessor;
+                    continue;
+                }
+
+                int a = predecessor;
+                int b = newIdom;
+                while (a != b) {
+                    while (rpoNumber[a] > rpoNumber[b]) {
+                        a = idom[a];
+                    }
+                    while (rpoNumber[b] > rpoNumber[a]) {
+                        b = idom[b];
+                    }
+                }
+                newIdom = a;
+            }
+            if (newIdom != idom[block]) {
+                idom[block] = newIdom;
+                changed = true;
+            }
+        }
+    }
+
+    domChildren.fill(QVector<int>(), count);
+    for (int i = 1; i < rpo.size(); ++i) {
+        domChildren[idom[rpo[i]]].append(rpo[i]);
+    }
+
+    preorder.fill(-1, count);
+    postorder.fill(-1, count);
+    int preCounter = 0;
+    int postCounter = 0;
+    QVector<QPair<int, int> > stack;
+    preorder[entry()] = preCounter++;
+    stack.append(qMakePair(entry(), 0));
+    while (!stack.isEmpty()) {
+        const int block = stack.last().first;
+        const int next = stack.last().second++;
+        if (next < domChildren[block].size()) {
+            const int child = domChildren[block][next];
+            preorder[child] = preCounter++;
+            stack.append(qMakePair(child, 0));
+        } else {
+            postorder[block] = postCounter++;
+            stack.removeLast();
+        }
+    }
+
+    backEdgeList.clear();
+    for (int block : rpo) {
+        for (int successor : blockList[block].successors) {
+            if (dominates(successor, block)) {
+                backEdgeList.append(qMakePair(block, successor));
+            }
+        }
+    }
+}
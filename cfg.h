@@ -0,0 +1,63 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include "triad.h"
+
+#include <QPair>
+#include <QVector>
+
+struct BasicBlock {
+    QVector<int> triads;          // Позиции триад в порядке выполнения
+    QVector<int> successors;
+    QVector<int> predecessors;
+    bool loopHeader;
+
+    BasicBlock() : loopHeader(false) {}
+};
+
+// Граф потока управления последовательности триад. Заголовок цикла содержит
+// условие; шаг цикла выполняется после тела, оттуда обратная дуга ведёт в заголовок.
+class ControlFlowGraph {
+public:
+    ControlFlowGraph(const QVector<Triad> &triads, const QVector<TriadLoop> &loops);
+
+    const QVector<BasicBlock> &blocks() const { return blockList; }
+    int entry() const { return 0; }
+
+    const QVector<int> &reversePostorder() const { return rpo; }
+    const QVector<QPair<int, int> > &backEdges() const { return backEdgeList; }
+
+    int immediateDominator(int block) const { return idom[block]; }
+    const QVector<int> &dominatorChildren(int block) const { return domChildren[block]; }
+    bool dominates(int a, int b) const;
+    QVector<QVector<int> > dominanceFrontiers() const;
+
+private:
+    struct LoopRange {
+        int begin;
+        int condition;
+        int body;
+        int end;
+    };
+
+    QVector<BasicBlock> blockList;
+    QVector<LoopRange> loopRanges;
+    QVector<QVector<int> > loopsAt;   // Циклы, начинающиеся в позиции, от внешнего к внутреннему
+
+    QVector<int> rpo;
+    QVector<int> rpoNumber;
+    QVector<int> idom;
+    QVector<QVector<int> > domChildren;
+    QVector<int> preorder;
+    QVector<int> postorder;
+    QVector<QPair<int, int> > backEdgeList;
+
+    int newBlock();
+    void addEdge(int from, int to);
+    int build(int from, int to, int block);
+
+    void computeOrder();
+    void computeDominators();
+};
+
+#endif // CFG_H
@@ -0,0 +1,288 @@
+#include "charscan.h"
+
+#include <QByteArray>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define CHARSCAN_X86
+#  define CHARSCAN_HAVE_AVX2
+#  define CHARSCAN_SSE2 __attribute__((target("sse2")))
+#  define CHARSCAN_AVX2 __attribute__((target("avx2")))
+#  include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#  define CHARSCAN_X86
+#  define CHARSCAN_SSE2
+#  include <intrin.h>
+#  include <emmintrin.h>
+#endif
+
+namespace CharScan {
+
+namespace {
+
+#ifdef CHARSCAN_X86
+inline int lowestBit(unsigned mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return int(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// Упаковка 16 кодовых единиц UTF-16 в байты с насыщением: всё, что не ASCII,
+// превращается в 0x80..0xFF или 0 и ни в один из классов ниже не попадает.
+CHARSCAN_SSE2 inline __m128i load16(const ushort *p)
+{
+    return _mm_packus_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)),
+                            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 8)));
+}
+
+CHARSCAN_SSE2 inline __m128i inRange(__m128i b, char lo, char hi)
+{
+    return _mm_and_si128(_mm_cmpgt_epi8(b, _mm_set1_epi8(char(lo - 1))),
+                         _mm_cmpgt_epi8(_mm_set1_epi8(char(hi + 1)), b));
+}
+#endif
+
+#ifdef CHARSCAN_HAVE_AVX2
+CHARSCAN_AVX2 inline __m256i load32(const ushort *p)
+{
+    __m256i packed = _mm256_packus_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)),
+                                         _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 16)));
+    // packus работает по 128-битным половинам, восстанавливаем порядок
+    return _mm256_permute4x64_epi64(packed, 0xd8);
+}
+
+CHARSCAN_AVX2 inline __m256i inRange(__m256i b, char lo, char hi)
+{
+    return _mm256_and_si256(_mm256_cmpgt_epi8(b, _mm256_set1_epi8(char(lo - 1))),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(char(hi + 1)), b));
+}
+#endif
+
+struct SpaceClass {
+    bool contains(ushort c) const { return c == ' ' || (c >= 0x09 && c <= 0x0d); }
+#ifdef CHARSCAN_X86
+    CHARSCAN_SSE2 __m128i sse2(__m128i b) const {
+        return _mm_or_si128(_mm_cmpeq_epi8(b, _mm_set1_epi8(' ')), inRange(b, 0x09, 0x0d));
+    }
+#endif
+#ifdef CHARSCAN_HAVE_AVX2
+    CHARSCAN_AVX2 __m256i avx2(__m256i b) const {
+        return _mm256_or_si256(_mm256_cmpeq_epi8(b, _mm256_set1_epi8(' ')), inRange(b, 0x09, 0x0d));
+    }
+#endif
+};
+
+struct IdentifierClass {
+    bool contains(ushort c) const {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+#ifdef CHARSCAN_X86
+    CHARSCAN_SSE2 __m128i sse2(__m128i b) const {
+        __m128i letters = _mm_or_si128(inRange(b, 'a', 'z'), inRange(b, 'A', 'Z'));
+        __m128i rest = _mm_or_si128(inRange(b, '0', '9'), _mm_cmpeq_epi8(b, _mm_set1_epi8('_')));
+        return _mm_or_si128(letters, rest);
+    }
+#endif
+#ifdef CHARSCAN_HAVE_AVX2
+    CHARSCAN_AVX2 __m256i avx2(__m256i b) const {
+        __m256i letters = _mm256_or_si256(inRange(b, 'a', 'z'), inRange(b, 'A', 'Z'));
+        __m256i rest = _mm256_or_si256(inRange(b, '0', '9'), _mm256_cmpeq_epi8(b, _mm256_set1_epi8('_')));
+        return _mm256_or_si256(letters, rest);
+    }
+#endif
+};
+
+struct DigitClass {
+    bool contains(ushort c) const { return c >= '0' && c <= '9'; }
+#ifdef CHARSCAN_X86
+    CHARSCAN_SSE2 __m128i sse2(__m128i b) const { return inRange(b, '0', '9'); }
+#endif
+#ifdef CHARSCAN_HAVE_AVX2
+    CHARSCAN_AVX2 __m256i avx2(__m256i b) const { return inRange(b, '0', '9'); }
+#endif
+};
+
+struct NotCharClass {
+    char c;
+    explicit NotCharClass(char c) : c(c) {}
+
+    bool contains(ushort u) const { return u != ushort(c); }
+#ifdef CHARSCAN_X86
+    CHARSCAN_SSE2 __m128i sse2(__m128i b) const {
+        return _mm_xor_si128(_mm_cmpeq_epi8(b, _mm_set1_epi8(c)), _mm_set1_epi8(char(-1)));
+    }
+#endif
+#ifdef CHARSCAN_HAVE_AVX2
+    CHARSCAN_AVX2 __m256i avx2(__m256i b) const {
+        return _mm256_xor_si256(_mm256_cmpeq_epi8(b, _mm256_set1_epi8(c)), _mm256_set1_epi8(char(-1)));
+    }
+#endif
+};
+
+struct ScalarScanner {
+    template <typename Class>
+    static int scan(const ushort *p, int from, int to, const Class &cls) {
+        while (from < to && cls.contains(p[from]))
+            ++from;
+        return from;
+    }
+};
+
+#ifdef CHARSCAN_X86
+struct Sse2Scanner {
+    template <typename Class>
+    CHARSCAN_SSE2 static int scan(const ushort *p, int from, int to, const Class &cls) {
+        for (; to - from >= 16; from += 16) {
+            unsigned mask = unsigned(_mm_movemask_epi8(cls.sse2(load16(p + from)))) ^ 0xffffu;
+            if (mask)
+                return from + lowestBit(mask);
+        }
+        return ScalarScanner::scan(p, from, to, cls);
+    }
+};
+#endif
+
+#ifdef CHARSCAN_HAVE_AVX2
+struct Avx2Scanner {
+    template <typename Class>
+    CHARSCAN_AVX2 static int scan(const ushort *p, int from, int to, const Class &cls) {
+        for (; to - from >= 32; from += 32) {
+            unsigned mask = unsigned(_mm256_movemask_epi8(cls.avx2(load32(p + from)))) ^ 0xffffffffu;
+            if (mask)
+                return from + lowestBit(mask);
+        }
+        return Sse2Scanner::scan(p, from, to, cls);
+    }
+};
+#endif
+
+template <typename Scanner>
+int spacesKernel(const ushort *p, int from, int to) { return Scanner::scan(p, from, to, SpaceClass()); }
+
+template <typename Scanner>
+int identifierKernel(const ushort *p, int from, int to) { return Scanner::scan(p, from, to, IdentifierClass()); }
+
+template <typename Scanner>
+int digitsKernel(const ushort *p, int from, int to) { return Scanner::scan(p, from, to, DigitClass()); }
+
+template <typename Scanner>
+int findKernel(const ushort *p, int from, int to, char c) { return Scanner::scan(p, from, to, NotCharClass(c)); }
+
+struct Kernels {
+    Isa isa;
+    int (*spaces)(const ushort *, int, int);
+    int (*identifier)(const ushort *, int, int);
+    int (*digits)(const ushort *, int, int);
+    int (*find)(const ushort *, int, int, char);
+};
+
+template <typename Scanner>
+Kernels makeKernels(Isa isa)
+{
+    Kernels kernels = {isa, &spacesKernel<Scanner>, &identifierKernel<Scanner>,
+                       &digitsKernel<Scanner>, &findKernel<Scanner>};
+    return kernels;
+}
+
+Isa detectIsa()
+{
+#if defined(CHARSCAN_HAVE_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return Avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return Sse2;
+    return Scalar;
+#elif defined(CHARSCAN_X86)
+    return Sse2;
+#else
+    return Scalar;
+#endif
+}
+
+Kernels selectKernels()
+{
+    Isa isa = detectIsa();
+
+    // TRANSLATOR_SIMD=scalar|sse2 принудительно понижает набор инструкций (для сравнения скорости)
+    const QByteArray forced = qgetenv("TRANSLATOR_SIMD").toLower();
+    if (forced == "scalar")
+        isa = Scalar;
+    else if (forced == "sse2" && isa > Sse2)
+        isa = Sse2;
+
+    switch (isa) {
+#ifdef CHARSCAN_HAVE_AVX2
+    case Avx2:
+        return makeKernels<Avx2Scanner>(Avx2);
+#endif
+#ifdef CHARSCAN_X86
+    case Sse2:
+        return makeKernels<Sse2Scanner>(Sse2);
+#endif
+    default:
+        return makeKernels<ScalarScanner>(Scalar);
+    }
+}
+
+const Kernels &kernels()
+{
+    static const Kernels selected = selectKernels();
+    return selected;
+}
+
+inline const ushort *units(const QChar *data)
+{
+    return reinterpret_cast<const ushort *>(data);
+}
+
+}
+
+int skipSpaces(const QChar *data, int from, int to)
+{
+    for (;;) {
+        from = kernels().spaces(units(data), from, to);
+        // Пробелы за пределами ASCII (U+00A0, U+2028 и т.п.) проверяются через QChar
+        if (from == to || data[from].unicode() < 0x80 || !data[from].isSpace())
+            return from;
+        ++from;
+    }
+}
+
+int skipIdentifier(const QChar *data, int from, int to)
+{
+    return kernels().identifier(units(data), from, to);
+}
+
+int skipDigits(const QChar *data, int from, int to)
+{
+    return kernels().digits(units(data), from, to);
+}
+
+int findChar(const QChar *data, int from, int to, char c)
+{
+    return kernels().find(units(data), from, to, c);
+}
+
+Isa activeIsa()
+{
+    return kernels().isa;
+}
+
+const char *isaName(Isa isa)
+{
+    switch (isa) {
+    case Avx2:
+        return "AVX2";
+    case Sse2:
+        return "SSE2";
+    default:
+        return "scalar";
+    }
+}
+
+}
@@ -0,0 +1,27 @@
+#ifndef CHARSCAN_H
+#define CHARSCAN_H
+
+#include <QChar>
+
+// Векторный поиск границ лексем (SSE2/AVX2 с выбором во время выполнения).
+// Все функции сканируют полуинтервал [from, to) и возвращают позицию
+// первого символа, не принадлежащего классу, либо to.
+namespace CharScan {
+
+enum Isa {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+int skipSpaces(const QChar *data, int from, int to);       // QChar::isSpace()
+int skipIdentifier(const QChar *data, int from, int to);   // [a-zA-Z0-9_]
+int skipDigits(const QChar *data, int from, int to);       // [0-9]
+int findChar(const QChar *data, int from, int to, char c); // первый c (ASCII, не 0)
+
+Isa activeIsa();
+const char *isaName(Isa isa);
+
+}
+
+#endif // CHARSCAN_H
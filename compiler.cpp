@@ -0,0 +1,651 @@
+#include "compiler.h"
+#include "lexer.h"
+#include "ssa.h"
+
+#include <QBitArray>
+
+#include <algorithm>
+
+void Compiler::setProfiling(bool enabled, const TriadProfile &previous)
+{
+    profiling = enabled;
+    previousProfile = previous;
+}
+
+CompileResult Compiler::compile(const QString &text, bool streaming, bool ssa)
+{
+    CompileResult result;
+    symbols.clear();
+
+    Lexer lexer(text, symbols);
+    if (streaming) {
+        LexerTokenStream stream(lexer);
+        result.parsed = parse(stream);
+    } else {
+        Token token;
+        while (lexer.next(token)) {
+            result.tokens.append(token);
+        }
+
+        TokenListStream stream(result.tokens);
+        result.parsed = parse(stream);
+    }
+
+    result.syntaxError = syntaxError;
+    if (result.parsed) {
+        result.syntaxTree = syntaxTree;
+        generateCode(result, ssa);
+    }
+    result.symbols = symbols;
+
+    return result;
+}
+
+CompileResult Compiler::compileTokens(const QList<Token> &tokens, const SymbolTable &table, bool generate, bool ssa)
+{
+    CompileResult result;
+    result.tokens = tokens;
+    symbols = table;
+
+    TokenListStream stream(result.tokens);
+    result.parsed = parse(stream);
+
+    result.syntaxError = syntaxError;
+    if (result.parsed) {
+        result.syntaxTree = syntaxTree;
+        if (generate) {
+            generateCode(result, ssa);
+        }
+    }
+    result.symbols = symbols;
+
+    return result;
+}
+
+bool Compiler::parse(TokenStream &tokens) {
+    syntaxTree.clear();
+    syntaxError.clear();
+
+    TreeNode root = {"node", "S", QVector<TreeNode>()};
+    int index = 0;
+    if (parseS(tokens, index, root)) {
+        if (!tokens.has(index)) {
+            syntaxTree = root;
+            return true;
+        }
+        // Программа разобрана, но за ней остались лексемы
+        syntaxError = tokens[index];
+    }
+    return false;
+}
+
+bool Compiler::parseS(TokenStream &tokens, int &index, TreeNode &treeNode) {
+    if (parseF(tokens, index, treeNode)) {
+        if (tokens.has(index) && tokens[index].value == ";") {
+            treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+            index++;
+            return true;
+        }
+    }
+    if (syntaxError.isNull()) {
+        syntaxError = tokens[index];
+    }
+    return false;
+}
+
+bool Compiler::parseF(TokenStream &tokens, int &index, TreeNode &treeNode) {
+    if (tokens.has(index) && tokens[index].value == "for") {
+        TreeNode child = {"node", "F", QVector<TreeNode>()};
+
+        child.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+        index++;
+        if (tokens.has(index) && tokens[index].value == "(") {
+            child.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+            index++;
+
+            TreeNode tNode = {"node", "T", QVector<TreeNode>()};
+            if (parseT(tokens, index, tNode)) {
+                child.children.append(tNode);
+                if (tokens.has(index) && tokens[index].value == ")") {
+                    child.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+                    index++;
+                    if (tokens.has(index) && tokens[index].value == "do") {
+                        child.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+                        index++;
+
+                        if (parseG(tokens, index, child)) {
+                            treeNode.children.append(child);
+                            return true;
+                        }
+                    }
+                }
+            }
+        }
+    } else if (parseG(tokens, index, treeNode)) {
+        return true;
+    }
+    if (syntaxError.isNull()) {
+        syntaxError = tokens[index];
+    }
+    return false;
+}
+
+bool Compiler::parseG(TokenStream &tokens, int &index, TreeNode &treeNode) {
+    if (tokens.has(index) && tokens[index].value == "for") {
+        if (parseF(tokens, index, treeNode)) {
+            return true;
+        }
+        if (syntaxError.isNull()) {
+            syntaxError = tokens[index];
+        }
+        return false;
+    } else if (tokens.has(index + 5) && tokens[index + 1].type == Assignment && tokens[index + 5].type == Assignment) {
+        TreeNode fNode1 = {"node", "F", QVector<TreeNode>()};
+        if (parseAssignment(tokens, index, fNode1)) {
+            treeNode.children.append(fNode1);
+            if (tokens.has(index) && tokens[index].value == ";") {
+                treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+                index++;
+
+                TreeNode fNode2 = {"node", "F", QVector<TreeNode>()};
+                if (tokens.has(index + 5) && tokens[index + 1].type == Assignment && tokens[index + 5].type == Assignment) {
+                    return parseG(tokens, index, treeNode);
+                } else {
+                    if (parseAssignment(tokens, index, fNode2)) {
+                        treeNode.children.append(fNode2);
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+    TreeNode fNode = {"node", "F", QVector<TreeNode>()};
+    if (parseAssignment(tokens, index, fNode)) {
+        treeNode.children.append(fNode);
+        return true;
+    }
+    return false;
+}
+
+bool Compiler::parseT(TokenStream &tokens, int &index, TreeNode &treeNode) {
+    if (tokens[index].value != ";") {
+
+        if (parseF(tokens, index, treeNode)) {
+            if (tokens[index].value == ";") {
+                treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+                index++;
+
+                TreeNode eNode = {"node", "E", QVector<TreeNode>()};
+                if (parseE(tokens, index, eNode)) {
+                    treeNode.children.append(eNode);
+                    if (tokens[index].value == ";") {
+                        treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+                        index++;
+
+                        if (tokens[index].value == ")") {
+                            return true;
+                        } else {
+                            return parseF(tokens, index, treeNode);
+                        }
+                    }
+                }
+            }
+        }
+    } else {
+        if (tokens[index].value == ";") {
+            treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+            index++;
+
+            TreeNode eNode = {"node", "E", QVector<TreeNode>()};
+            if (parseE(tokens, index, eNode)) {
+                treeNode.children.append(eNode);
+                if (tokens[index].value == ";") {
+                    treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+                    index++;
+
+                    if (tokens[index].value == ")") {
+                        return true;
+                    } else {
+                        return parseF(tokens, index, treeNode);
+                    }
+                }
+            }
+        }
+    }
+    if (syntaxError.isNull()) {
+        syntaxError = tokens[index];
+    }
+    return false;
+}
+
+bool Compiler::parseE(TokenStream &tokens, int &index, TreeNode &treeNode) {
+    if (tokens.has(index) && tokens[index].type == Identifier) {
+        treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+        index++;
+        if (tokens.has(index) && (tokens[index].value == "<" || tokens[index].value == ">" || tokens[index].value == "=")) {
+            treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+            index++;
+            if (tokens.has(index) && tokens[index].type == Number) {
+                treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+                index++;
+                return true;
+            }
+        }
+    }
+    if (syntaxError.isNull()) {
+        syntaxError = tokens[index];
+    }
+    return false;
+}
+
+bool Compiler::parseAssignment(TokenStream &tokens, int &index, TreeNode &treeNode) {
+    if (tokens.has(index) && tokens[index].type == Identifier) {
+        treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+        index++;
+        if(tokens.has(index) && tokens[index].type == Operator) {
+            treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+            index++;
+            return true;
+        }
+        if (tokens.has(index) && tokens[index].value == ":=") {
+            treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+            index++;
+            if (tokens.has(index) && (tokens[index].type == Identifier || tokens[index].type == StringConstant || tokens[index].type == Number)) {
+                treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>(), tokens[index].symbol});
+                index++;
+                return true;
+            }
+        }
+    }
+    if (syntaxError.isNull()) {
+        syntaxError = tokens[index];
+    }
+    return false;
+}
+
+QVector<Triad> Compiler::generateTriads(const TreeNode& node, int& counter, QMap<QString, int>& triadCache) {
+    QVector<Triad> triads;
+
+    if (node.type == "lexeme") {
+        return triads;
+    }
+
+    if (node.value == "F" && !node.children.isEmpty()) {
+        if (node.children.size() > 2 && node.children[1].value == ":=") {
+            QString leftOperand = node.children[0].value;
+            QString rightOperand = node.children[2].value;
+
+            triads.append(Triad(TriadAssign, leftOperand, rightOperand, node.children[0].symbol, node.children[2].symbol));
+            triads.last().index = ++counter;
+        }
+        else if (node.children.size() > 4 && node.children[0].value == "for") {
+            TreeNode tNode = node.children[2];
+
+            TriadLoop loop;
+            loop.begin = counter + 1;
+            loop.condition = 0;
+
+            QVector<Triad> tTriads;
+            for (const TreeNode& child : tNode.children) {
+                if (child.type == "node" && child.value == "E") {
+                    loop.condition = counter + 1;
+                }
+                tTriads.append(generateTriads(child, counter, triadCache));
+            }
+            triads.append(tTriads);
+
+            int conditionIndex = counter - tTriads.size() + 1;
+            loop.body = counter + 1;
+
+            QVector<Triad> bodyTriads;
+            for (const TreeNode& child : node.children) {
+                if (child.value == "F") {
+                    QVector<Triad> nestedBodyTriads = generateTriads(child, counter, triadCache);
+                    bodyTriads.append(nestedBodyTriads);
+                }
+            }
+
+            triads.append(bodyTriads);
+
+            triads.append(Triad(TriadFor, QString(), QString()));
+            triads.last().reference1 = conditionIndex;
+            triads.last().reference2 = counter;
+            triads.last().index = ++counter;
+
+            loop.end = counter;
+            if (loop.condition) {
+                loops.append(loop);
+            }
+        }
+        else if (node.children.size() > 2 && (node.children[1].value == "++" || node.children[1].value == "--")) {
+            QString leftOperand = node.children[0].value;
+            QString rightOperand = "1";
+
+            triads.append(Triad(node.children[1].value == "++" ? TriadAdd : TriadSubtract, leftOperand, rightOperand, node.children[0].symbol));
+            triads.last().index = ++counter;
+        }
+    }
+    else if (node.value == "T") {
+        for (const TreeNode& child : node.children) {
+            QVector<Triad> childTriads = generateTriads(child, counter, triadCache);
+            triads.append(childTriads);
+        }
+    }
+    else if (node.value == "E" && node.children.size() == 3) {
+        QString leftOperand = node.children[0].value;
+        const QString &comparison = node.children[1].value;
+        TriadOp operation = comparison == "<" ? TriadLess : comparison == ">" ? TriadGreater : TriadEqual;
+        QString rightOperand = node.children[2].value;
+
+        triads.append(Triad(operation, leftOperand, rightOperand, node.children[0].symbol, node.children[2].symbol));
+        triads.last().index = ++counter;
+    }
+
+    for (auto& triad : triads) {
+        if (triad.index == 0) {
+            triad.index = ++counter;
+        }
+    }
+
+    return triads;
+}
+
+QVector<Triad> Compiler::foldTriads(const QVector<Triad>& inputTriads) {
+    QVector<Triad> foldedTriads;
+    foldedTriads.reserve(inputTriads.size());
+    QVector<int> lastAssignment(symbols.size() + 1, -1);
+
+    for (const Triad& triad : inputTriads) {
+        Triad newTriad = triad;
+
+        if (newTriad.op == TriadAssign) {
+            int variable = newTriad.symbol1;
+            int value = newTriad.symbol2;
+
+            if (value && lastAssignment[value] != -1) {
+                const Triad &assigned = foldedTriads[lastAssignment[value]];
+
+                bool isConst = assigned.operand2.toInt(nullptr, 10);
+                if (isConst) {
+                    newTriad.operand2 = assigned.operand2;
+                    newTriad.symbol2 = assigned.symbol2;
+                }
+            }
+
+            lastAssignment[variable] = foldedTriads.size();
+        }
+
+        foldedTriads.append(newTriad);
+    }
+
+    for (int i = 0; i < foldedTriads.size(); ++i) {
+        foldedTriads[i].index = i + 1;
+    }
+
+    return foldedTriads;
+}
+
+QVector<Triad> Compiler::removeRedundantTriads(const QVector<Triad>& inputTriads) {
+    QVector<Triad> optimizedTriads;
+    QBitArray usedVariables(symbols.size() + 1);
+    QVector<int> lastAssignmentIdx(symbols.size() + 1, -1);
+
+    for (int i = 0; i < inputTriads.size(); ++i) {
+        const Triad& triad = inputTriads[i];
+
+        if (triad.op == TriadAssign) {
+            int variable = triad.symbol1;
+
+            if (lastAssignmentIdx[variable] != -1 && !usedVariables.testBit(variable)) {
+                optimizedTriads.removeAt(lastAssignmentIdx[variable]);
+            }
+
+            lastAssignmentIdx[variable] = optimizedTriads.size();
+        } else {
+            // Бит 0 ничему не соответствует: операнды-числа и ссылки ^N его и отмечают
+            usedVariables.setBit(triad.symbol1);
+            usedVariables.setBit(triad.symbol2);
+        }
+
+        optimizedTriads.append(triad);
+    }
+
+    // Ссылки ^N сохраняют прежние номера: их отображение на новые всегда было тождественным
+    for (int i = 0; i < optimizedTriads.size(); ++i) {
+        optimizedTriads[i].index = i + 1;
+    }
+
+    return optimizedTriads;
+}
+
+void Compiler::generateCode(CompileResult &result, bool ssa) {
+    int counter = 0;
+    QMap<QString, int> triadCache;
+    TreeNode rootNode = syntaxTree.children[0];
+    loops.clear();
+
+    result.baseTriads = generateTriads(rootNode, counter, triadCache);
+    result.loops = loops;
+
+    if (ssa) {
+        SsaForm form(result.baseTriads, result.loops, symbols);
+        form.numberValues();
+        result.ssaListing = form.listing();
+    }
+
+    result.foldedTriads = foldTriads(result.baseTriads);
+    if (profiling) {
+        optimizeByProfile(result);
+    } else {
+        result.optimizedTriads = removeRedundantTriads(result.foldedTriads);
+    }
+}
+
+void Compiler::optimizeByProfile(CompileResult &result) {
+    // Свёрнутые триады занимают те же номера, что и базовые, поэтому циклы к ним применимы
+    TriadInterpreter interpreter(result.foldedTriads, result.loops, symbols);
+    result.profile = interpreter.run();
+    result.profileReport = profileReport(result.profile, result.foldedTriads, result.loops);
+
+    QVector<Triad> triads = result.foldedTriads;
+    if (previousProfile.isEmpty()) {
+        result.profileReport << "Сохранённого профиля нет: оптимизация по профилю — при следующей компиляции";
+    } else if (previousProfile.key != result.profile.key) {
+        result.profileReport << "Сохранённый профиль относится к другой программе и не использован";
+    } else {
+        QVector<TriadLoop> hoistedLoops = result.loops;
+        QStringList hoisted;
+        triads = hoistLoopInvariants(result.foldedTriads, hoistedLoops, previousProfile, hoisted);
+
+        if (hoisted.isEmpty()) {
+            result.profileReport << "Инвариантов в горячих циклах не найдено";
+        } else {
+            result.profileReport << "Вынесено из горячих циклов:";
+            for (const QString &line : hoisted) {
+                result.profileReport << "    " + line;
+            }
+
+            // Бесконечные циклы обрываются по бюджету, поэтому программы сравниваются
+            // на одинаковом числе итераций циклов
+            const qint64 iterationLimit = result.profile.complete || result.profile.iterations == 0 ? -1 : result.profile.iterations;
+            const qint64 budget = 2 * TriadInterpreter::DefaultBudget;
+            TriadProfile before = TriadInterpreter(result.foldedTriads, result.loops, symbols).run(budget, iterationLimit);
+            TriadProfile after = TriadInterpreter(triads, hoistedLoops, symbols).run(budget, iterationLimit);
+            result.profileReport << QString("Выполнено триад до оптимизации: %1, после: %2, ускорение ×%3")
+                                    .arg(before.steps)
+                                    .arg(after.steps)
+                                    .arg(after.steps > 0 ? double(before.steps) / after.steps : 1.0, 0, 'f', 2);
+        }
+    }
+
+    result.optimizedTriads = removeRedundantTriads(triads);
+}
+
+QVector<Triad> Compiler::hoistLoopInvariants(const QVector<Triad>& inputTriads, QVector<TriadLoop>& triadLoops,
+                                             const TriadProfile& profile, QStringList& hoisted) {
+    const int count = inputTriads.size();
+
+    // Позиции триад считаются по номерам: номер = позиция + 1
+    for (int i = 0; i < count; ++i) {
+        if (inputTriads[i].index != i + 1) {
+            return inputTriads;
+        }
+    }
+
+    QVector<int> hotLoops;
+    for (int i = 0; i < triadLoops.size() && i < profile.loopCounts.size(); ++i) {
+        const TriadLoop &loop = triadLoops[i];
+        if (loop.begin < 1 || loop.condition < loop.begin || loop.body <= loop.condition ||
+            loop.end < loop.body || loop.end > count) {
+            continue;
+        }
+        if (profile.loopCounts[i] > 1 && profile.loopCounts[i] * HotLoopShare >= profile.iterations) {
+            hotLoops.append(i);
+        }
+    }
+
+    // Сначала внутренние циклы
+    std::stable_sort(hotLoops.begin(), hotLoops.end(), [&triadLoops](int a, int b) {
+        return triadLoops[a].end - triadLoops[a].begin < triadLoops[b].end - triadLoops[b].begin;
+    });
+
+    // Триады не двигаются до конца: вынесенная отмечает свой цикл в hoistedFrom и записывается
+    // перед его условием, а новая нумерация строится один раз. Вынесенная из вложенного цикла
+    // триада остаётся в его пределах, поэтому принадлежность триад циклам не меняется.
+    QVector<int> hoistedFrom(count, -1);
+    QVector<QVector<int> > hoistedBefore(count);
+    QVector<QPair<int, int> > moved;
+    for (int loopIndex : hotLoops) {
+        const int condition = triadLoops[loopIndex].condition - 1;
+        const int body = triadLoops[loopIndex].body - 1;
+        const int end = triadLoops[loopIndex].end - 1;
+
+        // Присваивания внутри цикла (условие, шаг, тело, вложенные циклы) и вхождения вне его
+        QVector<int> assignments(symbols.size() + 1, 0);
+        QBitArray outside(symbols.size() + 1);
+        for (int position = 0; position < count; ++position) {
+            const Triad &triad = inputTriads[position];
+            if (position < condition || position > end) {
+                outside.setBit(triad.symbol1);
+                outside.setBit(triad.symbol2);
+            } else if (triad.op == TriadAssign || triad.op == TriadAdd || triad.op == TriadSubtract) {
+                assignments[triad.symbol1]++;
+            }
+        }
+
+        // Последняя триада вложенного цикла по позиции его первой триады
+        QVector<int> nestedEnd(end - body, -1);
+        for (const TriadLoop &nested : triadLoops) {
+            if (nested.begin - 1 >= body && nested.begin - 1 < end && nested.end - 1 < end) {
+                nestedEnd[nested.begin - 1 - body] = qMax(nestedEnd[nested.begin - 1 - body], nested.end - 1);
+            }
+        }
+
+        // Выносится x := v из тела (не из вложенного цикла), если v не меняется в цикле,
+        // x присваивается в цикле один раз, не читается до этого в итерации и не встречается
+        // вне цикла: тогда и невыполненный ни разу цикл не изменит наблюдаемого результата.
+        // Вынесение может сделать инвариантной триаду выше по телу, поэтому проходы повторяются.
+        for (bool changed = true; changed;) {
+            changed = false;
+            QBitArray seen(symbols.size() + 1);
+            for (int position = condition; position < end; ++position) {
+                if (position >= body && nestedEnd[position - body] >= 0) {
+                    const int last = nestedEnd[position - body];
+                    for (; position <= last; ++position) {
+                        seen.setBit(inputTriads[position].symbol1);
+                        seen.setBit(inputTriads[position].symbol2);
+                    }
+                    position = last;
+                    continue;
+                }
+                if (hoistedFrom[position] == loopIndex) {
+                    continue;
+                }
+
+                const Triad &triad = inputTriads[position];
+                if (position >= body && triad.op == TriadAssign) {
+                    const int variable = triad.symbol1;
+                    const int value = triad.symbol2;
+                    bool invariant = value == 0 ? triad.reference2 == 0
+                                                : symbols.kind(value) == StringSymbol || assignments[value] == 0;
+                    if (invariant && variable > 0 && assignments[variable] == 1 &&
+                        !seen.testBit(variable) && !outside.testBit(variable)) {
+                        // Триада теперь вне цикла
+                        hoistedFrom[position] = loopIndex;
+                        hoistedBefore[condition].append(position);
+                        moved.append(qMakePair(position, loopIndex));
+                        assignments[variable]--;
+                        outside.setBit(variable);
+                        outside.setBit(value);
+                        changed = true;
+                        continue;
+                    }
+                }
+                seen.setBit(triad.symbol1);
+                seen.setBit(triad.symbol2);
+            }
+        }
+    }
+
+    if (moved.isEmpty()) {
+        return inputTriads;
+    }
+
+    QVector<Triad> triads;
+    triads.reserve(count);
+    QVector<int> newIndex(count + 1);
+    QVector<int> slotStart(count + 1);      // Первая триада, записанная на место позиции, с вынесенными перед ней
+    for (int position = 0; position < count; ++position) {
+        slotStart[position + 1] = triads.size() + 1;
+        for (int hoistedPosition : hoistedBefore[position]) {
+            newIndex[hoistedPosition + 1] = triads.size() + 1;
+            triads.append(inputTriads[hoistedPosition]);
+        }
+        if (hoistedFrom[position] < 0) {
+            newIndex[position + 1] = triads.size() + 1;
+            triads.append(inputTriads[position]);
+        }
+    }
+
+    auto remap = [&newIndex](int index) {
+        return index >= 1 && index < newIndex.size() ? newIndex[index] : index;
+    };
+    // Начало заголовка и тела включает триады, вынесенные перед условием вложенного цикла,
+    // который там начинается (цикл без инициализации); вынесенные из самого цикла — вне его
+    auto remapStart = [&](int index, int loopIndex) {
+        if (index < 1 || index > count) {
+            return index;
+        }
+        const QVector<int> &queued = hoistedBefore[index - 1];
+        return !queued.isEmpty() && hoistedFrom[queued.first()] == loopIndex ? newIndex[index] : slotStart[index];
+    };
+    for (int i = 0; i < triadLoops.size(); ++i) {
+        TriadLoop &loop = triadLoops[i];
+        // Если вынесены первые триады тела, тело начинается со следующей оставшейся
+        int body = loop.body;
+        while (body >= 1 && body < loop.end && body <= count && hoistedFrom[body - 1] >= 0) {
+            body++;
+        }
+        loop.begin = remapStart(loop.begin, i);
+        loop.condition = remap(loop.condition);
+        loop.body = remapStart(body, i);
+        loop.end = remap(loop.end);
+    }
+    for (int position = 0; position < count; ++position) {
+        triads[position].reference1 = remap(triads[position].reference1);
+        triads[position].reference2 = remap(triads[position].reference2);
+        triads[position].index = position + 1;
+    }
+    // Второй операнд for — последняя триада перед ним, а не перенесённая
+    for (const TriadLoop &loop : triadLoops) {
+        if (loop.end > 1 && loop.end <= count && triads[loop.end - 1].op == TriadFor) {
+            triads[loop.end - 1].reference2 = loop.end - 1;
+        }
+    }
+
+    for (const QPair<int, int> &item : moved) {
+        hoisted.append(QString("%1 — из цикла for ^%2").arg(inputTriads[item.first].toString()).arg(triadLoops[item.second].end));
+    }
+    return triads;
+}
@@ -0,0 +1,77 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include "profiler.h"
+#include "symboltable.h"
+#include "token.h"
+#include "tokenstream.h"
+#include "treeNode.h"
+#include "triad.h"
+
+#include <QList>
+#include <QMap>
+#include <QStringList>
+#include <QVector>
+
+struct CompileResult {
+    QList<Token> tokens;          // В потоковом режиме не заполняется
+    SymbolTable symbols;
+    bool parsed;
+    Token syntaxError;
+    TreeNode syntaxTree;
+    QVector<Triad> baseTriads;
+    QVector<TriadLoop> loops;     // Циклы в номерах базовых триад
+    QStringList ssaListing;       // Пуст, если SSA не строилась
+    QVector<Triad> foldedTriads;
+    QVector<Triad> optimizedTriads;
+    TriadProfile profile;         // Только при профилировании
+    QStringList profileReport;
+
+    CompileResult() : parsed(false) {}
+};
+
+// Полный цикл трансляции одного текста без обращения к интерфейсу,
+// поэтому может выполняться в фоновом потоке
+class Compiler {
+public:
+    Compiler() : profiling(false) {}
+
+    // Профилирование: свёрнутые триады выполняются интерпретатором, счётчики попадают
+    // в result.profile. Профиль прошлой компиляции той же программы направляет
+    // вынесение инвариантов из горячих циклов.
+    void setProfiling(bool enabled, const TriadProfile &previous = TriadProfile());
+
+    // ssa = false пропускает построение SSA-листинга (пакетный режим)
+    CompileResult compile(const QString &text, bool streaming = false, bool ssa = true);
+    // Разбор уже построенного списка лексем; при generate = false только синтаксический анализ
+    CompileResult compileTokens(const QList<Token> &tokens, const SymbolTable &table, bool generate, bool ssa = true);
+
+private:
+    SymbolTable symbols;
+    TreeNode syntaxTree;
+    Token syntaxError;
+    QVector<TriadLoop> loops;
+    bool profiling;
+    TriadProfile previousProfile;
+
+    static const int HotLoopShare = 100;   // Цикл горячий, если на него приходится не меньше 1% итераций
+
+    bool parse(TokenStream &tokens);
+    bool parseS(TokenStream &tokens, int &index, TreeNode &treeNode);
+    bool parseF(TokenStream &tokens, int &index, TreeNode &treeNode);
+    bool parseG(TokenStream &tokens, int &index, TreeNode &treeNode);
+    bool parseT(TokenStream &tokens, int &index, TreeNode &treeNode);
+    bool parseE(TokenStream &tokens, int &index, TreeNode &treeNode);
+    bool parseAssignment(TokenStream &tokens, int &index, TreeNode &treeNode);
+
+    QVector<Triad> generateTriads(const TreeNode& node, int& counter, QMap<QString, int>& triadCache);
+    QVector<Triad> foldTriads(const QVector<Triad>& inputTriads);
+    QVector<Triad> removeRedundantTriads(const QVector<Triad>& triads);
+    QVector<Triad> hoistLoopInvariants(const QVector<Triad>& inputTriads, QVector<TriadLoop>& triadLoops,
+                                       const TriadProfile& profile, QStringList& hoisted);
+
+    void generateCode(CompileResult &result, bool ssa);
+    void optimizeByProfile(CompileResult &result);
+};
+
+#endif // COMPILER_H
@@ -0,0 +1,101 @@
+#include "lexer.h"
+#include "charscan.h"
+
+Lexer::Lexer(const QString &text, SymbolTable &symbols)
+    : text(text), data(this->text.constData()), length(this->text.length()), symbols(symbols),
+      line(1), lineStart(0), position(0)
+{
+    lineEnd = CharScan::findChar(data, 0, length, '\n');
+}
+
+bool Lexer::next(Token &token)
+{
+    for (;;) {
+        if (position < lineEnd) {
+            position = CharScan::skipSpaces(data, position, lineEnd);
+        }
+
+        if (position < lineEnd && data[position] == '/' && position + 1 < lineEnd && data[position + 1] == '/') {
+            position = lineEnd;
+        }
+
+        if (position >= lineEnd) {
+            if (lineEnd >= length) {
+                return false;
+            }
+            lineStart = lineEnd + 1;
+            lineEnd = CharScan::findChar(data, lineStart, length, '\n');
+            position = lineStart;
+            line++;
+            continue;
+        }
+
+        const QChar ch = data[position];
+        const int column = position - lineStart + 1;
+
+        int closingQuote = lineEnd;
+        if (ch == '"' && (closingQuote = CharScan::findChar(data, position + 1, lineEnd, '"')) < lineEnd) {
+            int symbol = symbols.intern(text.mid(position, closingQuote - position + 1), StringSymbol);
+            token = Token(StringConstant, symbols.name(symbol), line, column, symbol);
+            position = closingQuote + 1;
+            return true;
+        }
+
+        if (ch == ':' && position + 1 < lineEnd && data[position + 1] == '=') {
+            token = Token(Assignment, ":=", line, column);
+            position += 2;
+            return true;
+        }
+
+        if ((ch == '+' || ch == '-') && position + 1 < lineEnd && data[position + 1] == ch) {
+            token = Token(Operator, text.mid(position, 2), line, column);
+            position += 2;
+            return true;
+        }
+
+        if (ch == '<' || ch == '>' || ch == '=') {
+            token = Token(Comparison, QString(ch), line, column);
+            position++;
+            return true;
+        }
+
+        if (ch >= '0' && ch <= '9') {
+            const int end = CharScan::skipDigits(data, position, lineEnd);
+            token = Token(Number, text.mid(position, end - position), line, column);
+            position = end;
+            return true;
+        }
+
+        if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_') {
+            const int end = CharScan::skipIdentifier(data, position, lineEnd);
+
+            // Ключевое слово может быть склеено с идентификатором через '_' ("for_x"),
+            // поэтому проверяется только буквенно-цифровой префикс
+            int wordEnd = position;
+            while (wordEnd < end && data[wordEnd] != '_') {
+                wordEnd++;
+            }
+
+            if (const QString *keyword = SymbolTable::keyword(data + position, wordEnd - position)) {
+                token = Token(Keyword, *keyword, line, column);
+                position = wordEnd;
+                return true;
+            }
+
+            int symbol = symbols.intern(text.mid(position, end - position), VariableSymbol);
+            token = Token(Identifier, symbols.name(symbol), line, column, symbol);
+            position = end;
+            return true;
+        }
+
+        if (ch == '(' || ch == ')' || ch == '{' || ch == '}' || ch == ';') {
+            token = Token(SpecialChar, QString(ch), line, column);
+            position++;
+            return true;
+        }
+
+        token = Token(Error, QString("Неопознанный символ: %1").arg(ch), line, column);
+        position++;
+        return true;
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include "symboltable.h"
+#include "token.h"
+
+#include <QString>
+
+// Лексический анализатор, выдающий лексемы по одной по запросу
+class Lexer {
+public:
+    Lexer(const QString &text, SymbolTable &symbols);
+
+    bool next(Token &token);
+
+private:
+    QString text;
+    const QChar *data;
+    int length;
+    SymbolTable &symbols;
+
+    int line;
+    int lineStart;
+    int lineEnd;
+    int position;
+};
+
+#endif // LEXER_H
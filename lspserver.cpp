@@ -0,0 +1,464 @@
+#include "lspserver.h"
+#include "lexer.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <cstdio>
+
+#ifdef Q_OS_WIN
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+// Коды ошибок JSON-RPC
+static const int ParseError = -32700;
+static const int InvalidRequest = -32600;
+static const int MethodNotFound = -32601;
+
+// Индексы в legend.tokenTypes
+static const char *const SemanticTypes[] = {"variable", "keyword", "number", "string", "operator"};
+
+LspServer::LspServer()
+    : shutdownRequested(false), exitRequested(false)
+{
+#ifdef Q_OS_WIN
+    // Content-Length считается в байтах, преобразование \r\n недопустимо
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+}
+
+int LspServer::run()
+{
+    QByteArray body;
+    while (!exitRequested && readMessage(body)) {
+        QJsonParseError error;
+        QJsonDocument json = QJsonDocument::fromJson(body, &error);
+        if (error.error != QJsonParseError::NoError) {
+            respondError(QJsonValue(), ParseError, error.errorString());
+            continue;
+        }
+        if (!json.isObject()) {
+            respondError(QJsonValue(), InvalidRequest, "Ожидался объект JSON-RPC");
+            continue;
+        }
+        handle(json.object());
+    }
+
+    return shutdownRequested ? 0 : 1;
+}
+
+bool LspServer::readMessage(QByteArray &body)
+{
+    int contentLength = -1;
+    char header[1024];
+    for (;;) {
+        if (!std::fgets(header, sizeof(header), stdin)) {
+            return false;
+        }
+
+        QByteArray line = QByteArray(header).trimmed();
+        if (line.isEmpty()) {
+            if (contentLength >= 0) {
+                break;
+            }
+            continue;
+        }
+        if (line.toLower().startsWith("content-length:")) {
+            contentLength = line.mid(15).trimmed().toInt();
+        }
+    }
+
+    body.resize(contentLength);
+    return std::fread(body.data(), 1, contentLength, stdin) == static_cast<size_t>(contentLength);
+}
+
+void LspServer::send(const QJsonObject &message)
+{
+    QByteArray body = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    QByteArray header = "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n";
+    std::fwrite(header.constData(), 1, header.size(), stdout);
+    std::fwrite(body.constData(), 1, body.size(), stdout);
+    std::fflush(stdout);
+}
+
+void LspServer::respond(const QJsonValue &id, const QJsonValue &result)
+{
+    QJsonObject message;
+    message["jsonrpc"] = "2.0";
+    message["id"] = id;
+    message["result"] = result;
+    send(message);
+}
+
+void LspServer::respondError(const QJsonValue &id, int code, const QString &text)
+{
+    QJsonObject error;
+    error["code"] = code;
+    error["message"] = text;
+
+    QJsonObject message;
+    message["jsonrpc"] = "2.0";
+    message["id"] = id.isUndefined() ? QJsonValue() : id;
+    message["error"] = error;
+    send(message);
+}
+
+void LspServer::notify(const QString &method, const QJsonObject &params)
+{
+    QJsonObject message;
+    message["jsonrpc"] = "2.0";
+    message["method"] = method;
+    message["params"] = params;
+    send(message);
+}
+
+void LspServer::handle(const QJsonObject &message)
+{
+    const QString method = message["method"].toString();
+    const QJsonObject params = message["params"].toObject();
+    const QJsonValue id = message["id"];
+    const bool request = message.contains("id");
+
+    if (method == "initialize") {
+        respond(id, initialize());
+    } else if (method == "shutdown") {
+        shutdownRequested = true;
+        respond(id, QJsonValue());
+    } else if (method == "exit") {
+        exitRequested = true;
+    } else if (method == "textDocument/didOpen") {
+        openDocument(params);
+    } else if (method == "textDocument/didChange") {
+        changeDocument(params);
+    } else if (method == "textDocument/didClose") {
+        closeDocument(params);
+    } else if (method == "textDocument/semanticTokens/full") {
+        respond(id, semanticTokens(params));
+    } else if (method == "textDocument/hover") {
+        respond(id, hover(params));
+    } else if (request) {
+        respondError(id, MethodNotFound, QString("Метод не поддерживается: %1").arg(method));
+    }
+    // Прочие уведомления (initialized, $/cancelRequest, ...) не требуют ответа
+}
+
+QJsonObject LspServer::initialize() const
+{
+    QJsonArray tokenTypes;
+    for (const char *type : SemanticTypes) {
+        tokenTypes.append(QString(type));
+    }
+
+    QJsonObject legend;
+    legend["tokenTypes"] = tokenTypes;
+    legend["tokenModifiers"] = QJsonArray();
+
+    QJsonObject semanticTokensProvider;
+    semanticTokensProvider["legend"] = legend;
+    semanticTokensProvider["full"] = true;
+
+    QJsonObject textDocumentSync;
+    textDocumentSync["openClose"] = true;
+    textDocumentSync["change"] = 2;    // Incremental
+
+    QJsonObject capabilities;
+    capabilities["textDocumentSync"] = textDocumentSync;
+    capabilities["hoverProvider"] = true;
+    capabilities["semanticTokensProvider"] = semanticTokensProvider;
+
+    QJsonObject serverInfo;
+    serverInfo["name"] = "translator";
+
+    QJsonObject result;
+    result["capabilities"] = capabilities;
+    result["serverInfo"] = serverInfo;
+    return result;
+}
+
+void LspServer::openDocument(const QJsonObject &params)
+{
+    const QJsonObject textDocument = params["textDocument"].toObject();
+    const QString uri = textDocument["uri"].toString();
+
+    Document &document = documents[uri];
+    document.version = textDocument["version"].toInt();
+    setText(document, textDocument["text"].toString());
+    analyze(uri, document);
+}
+
+void LspServer::changeDocument(const QJsonObject &params)
+{
+    const QJsonObject textDocument = params["textDocument"].toObject();
+    const QString uri = textDocument["uri"].toString();
+    if (!documents.contains(uri)) {
+        return;
+    }
+
+    Document &document = documents[uri];
+    document.version = textDocument["version"].toInt();
+
+    for (const QJsonValue &value : params["contentChanges"].toArray()) {
+        const QJsonObject change = value.toObject();
+        const QString text = change["text"].toString();
+        if (!change.contains("range")) {
+            setText(document, text);
+            continue;
+        }
+
+        const QJsonObject start = change["range"].toObject()["start"].toObject();
+        const QJsonObject end = change["range"].toObject()["end"].toObject();
+        const int lastLine = document.lines.size() - 1;
+        const int startLine = qBound(0, start["line"].toInt(), lastLine);
+        const int endLine = qBound(startLine, end["line"].toInt(), lastLine);
+
+        // Позиции в LSP по умолчанию в единицах UTF-16, как и в QString
+        const QString prefix = document.lines[startLine].left(start["character"].toInt());
+        const QString suffix = document.lines[endLine].mid(end["character"].toInt());
+        const QStringList inserted = (prefix + text + suffix).split('\n');
+
+        document.lines.erase(document.lines.begin() + startLine, document.lines.begin() + endLine + 1);
+        for (int i = 0; i < inserted.size(); ++i) {
+            document.lines.insert(startLine + i, inserted[i]);
+        }
+        relex(document, startLine, endLine - startLine + 1, inserted.size());
+    }
+
+    // Символы удалённых строк остаются в таблице; когда их набирается много, таблица строится заново
+    if (document.symbols.size() > 2 * document.tokens.size() + 1024) {
+        setText(document, document.lines.join('\n'));
+    }
+
+    analyze(uri, document);
+}
+
+void LspServer::closeDocument(const QJsonObject &params)
+{
+    const QString uri = params["textDocument"].toObject()["uri"].toString();
+    documents.remove(uri);
+
+    QJsonObject diagnostics;
+    diagnostics["uri"] = uri;
+    diagnostics["diagnostics"] = QJsonArray();
+    notify("textDocument/publishDiagnostics", diagnostics);
+}
+
+QJsonObject LspServer::semanticTokens(const QJsonObject &params)
+{
+    const QString uri = params["textDocument"].toObject()["uri"].toString();
+
+    // Относительная кодировка: сдвиг строки, сдвиг столбца, длина, тип, модификаторы
+    QJsonArray data;
+    if (documents.contains(uri)) {
+        const Document &document = documents[uri];
+        int previousLine = 0;
+        int previousColumn = 0;
+        for (const Token &token : document.tokens) {
+            const int type = semanticType(token.type);
+            if (type < 0) {
+                continue;
+            }
+
+            const int line = token.line - 1;
+            const int column = token.column - 1;
+            data.append(line - previousLine);
+            data.append(line == previousLine ? column - previousColumn : column);
+            data.append(tokenLength(token));
+            data.append(type);
+            data.append(0);
+            previousLine = line;
+            previousColumn = column;
+        }
+    }
+
+    QJsonObject result;
+    result["data"] = data;
+    return result;
+}
+
+QJsonValue LspServer::hover(const QJsonObject &params)
+{
+    const QString uri = params["textDocument"].toObject()["uri"].toString();
+    if (!documents.contains(uri)) {
+        return QJsonValue();
+    }
+
+    Document &document = documents[uri];
+    const QJsonObject position = params["position"].toObject();
+    const int line = position["line"].toInt();
+    const int character = position["character"].toInt();
+    if (line < 0 || line >= document.lineTokens.size()) {
+        return QJsonValue();
+    }
+
+    int found = -1;
+    const QList<Token> &lineTokens = document.lineTokens[line];
+    for (int i = 0; i < lineTokens.size(); ++i) {
+        if (character >= lineTokens[i].column - 1 && character < lineTokens[i].column - 1 + tokenLength(lineTokens[i])) {
+            found = i;
+            break;
+        }
+    }
+    if (found < 0) {
+        return QJsonValue();
+    }
+    const Token &token = lineTokens[found];
+
+    QString text = QString("**%1** `%2`").arg(tokenTypeName(token.type), token.value);
+    if (token.symbol != 0) {
+        if (!document.generated) {
+            Compiler compiler;
+            document.result = compiler.compileTokens(document.tokens, document.symbols, true, false);
+            document.generated = true;
+        }
+
+        if (!document.result.parsed) {
+            text += "\n\nТриады недоступны: ошибка синтаксического анализа";
+        } else {
+            QStringList triads;
+            for (const Triad &triad : document.result.optimizedTriads) {
+                if (triad.symbol1 == token.symbol || triad.symbol2 == token.symbol) {
+                    triads.append(QString::number(triad.index) + ". " + triad.toString());
+                }
+            }
+            if (triads.isEmpty()) {
+                text += "\n\nНе используется в оптимизированных триадах";
+            } else {
+                text += "\n\n```\n" + triads.join('\n') + "\n```";
+            }
+        }
+    }
+
+    QJsonObject contents;
+    contents["kind"] = "markdown";
+    contents["value"] = text;
+
+    QJsonObject result;
+    result["contents"] = contents;
+    result["range"] = range(line, token.column - 1, tokenLength(token));
+    return result;
+}
+
+void LspServer::setText(Document &document, const QString &text)
+{
+    document.lines = text.split('\n');
+    document.lineTokens.clear();
+    document.symbols.clear();
+    relex(document, 0, 0, document.lines.size());
+}
+
+void LspServer::relex(Document &document, int firstLine, int removedLines, int insertedLines)
+{
+    // Лексемы не переходят границу строки, поэтому изменённые строки разбираются отдельно
+    QStringList changed;
+    for (int i = 0; i < insertedLines; ++i) {
+        changed.append(document.lines[firstLine + i]);
+    }
+
+    QVector<QList<Token> > lexed(insertedLines);
+    Lexer lexer(changed.join('\n'), document.symbols);
+    Token token;
+    while (lexer.next(token)) {
+        lexed[token.line - 1].append(token);
+    }
+
+    document.lineTokens.remove(firstLine, removedLines);
+    document.lineTokens.insert(firstLine, insertedLines, QList<Token>());
+    for (int i = 0; i < insertedLines; ++i) {
+        document.lineTokens[firstLine + i].swap(lexed[i]);
+    }
+}
+
+void LspServer::analyze(const QString &uri, Document &document)
+{
+    document.tokens.clear();
+    for (int line = 0; line < document.lineTokens.size(); ++line) {
+        for (Token token : document.lineTokens[line]) {
+            token.line = line + 1;
+            document.tokens.append(token);
+        }
+    }
+
+    // Для диагностики достаточно синтаксического анализа; триады — при первом запросе подсказки
+    Compiler compiler;
+    document.result = compiler.compileTokens(document.tokens, document.symbols, false);
+    document.generated = false;
+
+    publishDiagnostics(uri, document);
+}
+
+void LspServer::publishDiagnostics(const QString &uri, const Document &document)
+{
+    QJsonArray diagnostics;
+
+    for (const Token &token : document.tokens) {
+        if (token.type == Error) {
+            QJsonObject diagnostic;
+            diagnostic["range"] = range(token.line - 1, token.column - 1, 1);
+            diagnostic["severity"] = 1;
+            diagnostic["source"] = "translator";
+            diagnostic["message"] = token.value;
+            diagnostics.append(diagnostic);
+        }
+    }
+
+    // Разбор, остановившийся на ошибочной лексеме, уже отмечен выше
+    const Token &error = document.result.syntaxError;
+    if (!document.result.parsed && error.type != Error) {
+        QJsonObject diagnostic;
+        if (error.type != EndOfText) {
+            diagnostic["range"] = range(error.line - 1, error.column - 1, tokenLength(error));
+            diagnostic["message"] = QString("Ошибка синтаксического анализа: лексема %1").arg(error.value);
+        } else {
+            const int lastLine = document.lines.size() - 1;
+            diagnostic["range"] = range(lastLine, document.lines[lastLine].length(), 0);
+            diagnostic["message"] = "Ошибка синтаксического анализа: неожиданный конец текста";
+        }
+        diagnostic["severity"] = 1;
+        diagnostic["source"] = "translator";
+        diagnostics.append(diagnostic);
+    }
+
+    QJsonObject params;
+    params["uri"] = uri;
+    params["version"] = document.version;
+    params["diagnostics"] = diagnostics;
+    notify("textDocument/publishDiagnostics", params);
+}
+
+int LspServer::semanticType(TokenType type)
+{
+    switch (type) {
+    case Identifier:
+        return 0;
+    case Keyword:
+        return 1;
+    case Number:
+        return 2;
+    case StringConstant:
+        return 3;
+    case Operator:
+    case Comparison:
+    case Assignment:
+        return 4;
+    default:
+        return -1;
+    }
+}
+
+QJsonObject LspServer::range(int line, int character, int length)
+{
+    QJsonObject start;
+    start["line"] = line;
+    start["character"] = character;
+
+    QJsonObject end;
+    end["line"] = line;
+    end["character"] = character + length;
+
+    QJsonObject result;
+    result["start"] = start;
+    result["end"] = end;
+    return result;
+}
@@ -0,0 +1,65 @@
+#ifndef LSPSERVER_H
+#define LSPSERVER_H
+
+#include "compiler.h"
+#include "symboltable.h"
+#include "token.h"
+
+#include <QHash>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QList>
+#include <QStringList>
+#include <QVector>
+
+// Сервер Language Server Protocol поверх stdin/stdout. Документ хранится по
+// строкам вместе с лексемами каждой строки: при правке заново разбираются
+// на лексемы только изменённые строки, а диагностика строится одним
+// синтаксическим анализом. Триады для подсказок строятся по запросу.
+class LspServer {
+public:
+    LspServer();
+
+    int run();
+
+private:
+    struct Document {
+        int version;
+        QStringList lines;
+        QVector<QList<Token> > lineTokens;   // Номер строки у лексем не поддерживается
+        SymbolTable symbols;
+        QList<Token> tokens;
+        CompileResult result;
+        bool generated;                      // Триады построены для текущей версии
+
+        Document() : version(0), generated(false) {}
+    };
+
+    QHash<QString, Document> documents;
+    bool shutdownRequested;
+    bool exitRequested;
+
+    bool readMessage(QByteArray &body);
+    void send(const QJsonObject &message);
+    void respond(const QJsonValue &id, const QJsonValue &result);
+    void respondError(const QJsonValue &id, int code, const QString &message);
+    void notify(const QString &method, const QJsonObject &params);
+
+    void handle(const QJsonObject &message);
+    QJsonObject initialize() const;
+    void openDocument(const QJsonObject &params);
+    void changeDocument(const QJsonObject &params);
+    void closeDocument(const QJsonObject &params);
+    QJsonObject semanticTokens(const QJsonObject &params);
+    QJsonValue hover(const QJsonObject &params);
+
+    void setText(Document &document, const QString &text);
+    void relex(Document &document, int firstLine, int removedLines, int insertedLines);
+    void analyze(const QString &uri, Document &document);
+    void publishDiagnostics(const QString &uri, const Document &document);
+
+    static int semanticType(TokenType type);
+    static QJsonObject range(int line, int character, int length);
+};
+
+#endif // LSPSERVER_H
@@ -1,9 +1,20 @@
+#include "lspserver.h"
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <cstring>
 
 int main(int argc, char *argv[])
 {
+    // translator --lsp: сервер языка поверх stdin/stdout без окна
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--lsp") == 0) {
+            QCoreApplication a(argc, argv);
+            LspServer server;
+            return server.run();
+        }
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
@@ -1,5 +1,13 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
+#include "charscan.h"
+
+#include <QCryptographicHash>
+#include <QScrollBar>
+#include <QTextCursor>
+#include <QtConcurrent>
+
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), ui(new Ui::MainWindow)
@@ -9,7 +17,9 @@ MainWindow::MainWindow(QWidget *parent)
     this->setWindowTitle("Устинов Илья ИС-41");
 
     textEdit = new QPlainTextEdit(this);
-    textEdit->setEnabled(false);
+    textEdit->setReadOnly(true);
+    textEdit->setUndoRedoEnabled(false);
+    highlighter = new TokenHighlighter(textEdit);
 
     lexicalTable = new QTableWidget(this);
     precedenceMatrixTable = new QTableWidget(this);
@@ -18,12 +28,43 @@ MainWindow::MainWindow(QWidget *parent)
     baseTriadsList = new QListWidget(this);
     foldingTriadsList = new QListWidget(this);
     resultTriadsList = new QListWidget(this);
+    profileList = new QListWidget(this);
+    ssaList = new QListWidget(this);
+    batchTable = new QTableWidget(this);
 
     loadFileButton = new QPushButton("Выбрать файл", this);
+    batchButton = new QPushButton("Пакетная компиляция файлов", this);
+    batchDirectoryButton = new QPushButton("Пакетная компиляция каталога", this);
+    streamingCheckBox = new QCheckBox("Потоковый разбор (без таблицы лексем и матрицы предшествования)", this);
+    watchCheckBox = new QCheckBox("Следить за изменениями файла", this);
+    profileCheckBox = new QCheckBox("Профилирование и оптимизация горячих циклов по профилю", this);
+
+    fileWatcher = new QFileSystemWatcher(this);
+    debounceTimer = new QTimer(this);
+    debounceTimer->setSingleShot(true);
+    debounceTimer->setInterval(DebounceMs);
+    compileWatcher = new QFutureWatcher<CompileResult>(this);
+    recompilePending = false;
+    loadCompile = false;
+    loadGeneration = 0;
+    compileGeneration = 0;
+
+    documentOffset = 0;
+    restoreScroll = -1;
+    documentTimer = new QTimer(this);
+    documentTimer->setInterval(0);
+    batchWatcher = new QFutureWatcher<BatchResult>(this);
 
     QWidget *tab1 = new QWidget;
     QVBoxLayout *textInputLayout = new QVBoxLayout(tab1);
-    textInputLayout->addWidget(loadFileButton);
+    QHBoxLayout *buttonsLayout = new QHBoxLayout;
+    buttonsLayout->addWidget(loadFileButton);
+    buttonsLayout->addWidget(batchButton);
+    buttonsLayout->addWidget(batchDirectoryButton);
+    textInputLayout->addLayout(buttonsLayout);
+    textInputLayout->addWidget(streamingCheckBox);
+    textInputLayout->addWidget(watchCheckBox);
+    textInputLayout->addWidget(profileCheckBox);
     textInputLayout->addWidget(textEdit);
     ui->tabWidget->addTab(tab1, "Исходный текст");
 
@@ -43,12 +84,25 @@ MainWindow::MainWindow(QWidget *parent)
     ui->tabWidget->addTab(tab4, "Синтаксическое дерево");
 
     QWidget *tab5 = new QWidget;
-    QHBoxLayout *triadsLayout = new QHBoxLayout(tab5);
+    QVBoxLayout *triadsTabLayout = new QVBoxLayout(tab5);
+    QHBoxLayout *triadsLayout = new QHBoxLayout;
     triadsLayout->addWidget(baseTriadsList);
     triadsLayout->addWidget(foldingTriadsList);
     triadsLayout->addWidget(resultTriadsList);
+    triadsTabLayout->addLayout(triadsLayout, 3);
+    triadsTabLayout->addWidget(profileList, 1);
     ui->tabWidget->addTab(tab5, "Триады");
 
+    QWidget *tab6 = new QWidget;
+    QVBoxLayout *ssaLayout = new QVBoxLayout(tab6);
+    ssaLayout->addWidget(ssaList);
+    ui->tabWidget->addTab(tab6, "Граф управления (SSA)");
+
+    QWidget *tab7 = new QWidget;
+    QVBoxLayout *batchLayout = new QVBoxLayout(tab7);
+    batchLayout->addWidget(batchTable);
+    ui->tabWidget->addTab(tab7, "Пакетная компиляция");
+
     lexicalTable->setColumnCount(4);
     lexicalTable->setHorizontalHeaderLabels({"Тип", "Значение", "Строка", "Столбец"});
     lexicalTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
@@ -59,381 +113,462 @@ MainWindow::MainWindow(QWidget *parent)
     precedenceMatrixTable->verticalHeader()->setSectionResizeMode(QHeaderView::Stretch);
 
     syntaxTreeWidget->setHeaderHidden(true);
+    profileList->setVisible(false);
+
+    batchTable->setColumnCount(4);
+    batchTable->setHorizontalHeaderLabels({"Файл", "Результат", "Время, мс", "Триад"});
+    batchTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    batchTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
+    batchTable->horizontalHeader()->setSectionResizeMode(3, QHeaderView::ResizeToContents);
+    batchTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
 
     connect(loadFileButton, &QPushButton::clicked, this, &MainWindow::onLoadFile);
+    connect(watchCheckBox, &QCheckBox::toggled, this, &MainWindow::onWatchToggled);
+    connect(fileWatcher, &QFileSystemWatcher::fileChanged, this, &MainWindow::onFileChanged);
+    connect(debounceTimer, &QTimer::timeout, this, &MainWindow::onRecompile);
+    connect(compileWatcher, &QFutureWatcher<CompileResult>::finished, this, &MainWindow::onCompileFinished);
+    connect(documentTimer, &QTimer::timeout, this, &MainWindow::onAppendDocumentChunk);
+    connect(batchButton, &QPushButton::clicked, this, &MainWindow::onBatchCompileFiles);
+    connect(batchDirectoryButton, &QPushButton::clicked, this, &MainWindow::onBatchCompileDirectory);
+    connect(batchWatcher, &QFutureWatcher<BatchResult>::finished, this, &MainWindow::onBatchFinished);
 }
 
 MainWindow::~MainWindow()
 {
+    compileWatcher->waitForFinished();
+    batchWatcher->waitForFinished();
     delete ui;
 }
 
+// Место синтаксической ошибки: лексема либо конец текста, если лексемы кончились
+static QString syntaxErrorText(const Token &error)
+{
+    if (error.type == EndOfText) {
+        return "неожиданный конец текста";
+    }
+    return QString("лексема %1, строка %2, столбец %3").arg(error.value, QString::number(error.line), QString::number(error.column));
+}
+
 void MainWindow::onLoadFile()
 {
     QString fileName = QFileDialog::getOpenFileName(this, "Выбрать файл", "", "Текстовые файлы (*.txt);;Все файлы (*.*)");
     if (fileName.isEmpty())
         return;
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    QByteArray data;
+    if (!readSource(fileName, data)) {
         QMessageBox::critical(this, "Ошибка", "Не удалось открыть файл");
         return;
     }
 
-    QString content = file.readAll();
-    file.close();
-    textEdit->setPlainText(content);
+    if (fileWatcher->files().contains(sourceFileName)) {
+        fileWatcher->removePath(sourceFileName);
+    }
+    sourceFileName = fileName;
+    sourceHash = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+    loadGeneration++;
+    debounceTimer->stop();
+    changeTimer.invalidate();
+    if (watchCheckBox->isChecked()) {
+        fileWatcher->addPath(sourceFileName);
+    }
 
-    QList<Token> tokens = lexicalAnalysis(content);\
+    // Текст показывается сразу, а компиляция (с профилированием) идёт в фоне
+    pendingSource = QString::fromUtf8(data);
+    pendingHash = sourceHash;
+    loadCompile = true;
+    recompilePending = false;
+    highlighter->setTokens(QList<Token>());
+    highlighter->setSyntaxError(Token());
+    loadDocument(pendingSource, 0);
+    ui->statusbar->showMessage(QString("Компиляция %1...").arg(sourceFileName));
+
+    // Компиляция прежнего файла ещё идёт: её результат отбросится, и тогда начнётся эта
+    if (!compileWatcher->isRunning()) {
+        startCompile();
+    }
+}
 
-    if (parse(tokens)) {
-        QMessageBox::information(this, "Синтаксический анализ", "Анализ успешно завершен!");
-        syntaxAnalysis(tokens);
-        generateCode();
+void MainWindow::onWatchToggled(bool enabled)
+{
+    if (sourceFileName.isEmpty())
+        return;
 
+    if (enabled) {
+        fileWatcher->addPath(sourceFileName);
     } else {
-        QMessageBox::critical(this, "Синтаксический анализ", QString("Ошибка синтаксического анализа! Лексема %1, строка %2, столбец %3").arg(syntaxError.value, QString::number(syntaxError.line), QString::number(syntaxError.column)));
+        if (fileWatcher->files().contains(sourceFileName)) {
+            fileWatcher->removePath(sourceFileName);
+        }
+        debounceTimer->stop();
+        changeTimer.invalidate();
     }
-
 }
 
-QList<Token> MainWindow::lexicalAnalysis(const QString &text)
+void MainWindow::onFileChanged(const QString &path)
 {
-    QStringList lines = text.split('\n');
-    lexicalTable->setRowCount(0);
+    // Редакторы, сохраняющие файл через переименование, снимают его с наблюдения
+    if (!fileWatcher->files().contains(path) && QFile::exists(path)) {
+        fileWatcher->addPath(path);
+    }
 
-    QList<Token> tokens;
+    if (!changeTimer.isValid()) {
+        changeTimer.start();
+    }
 
-    QRegularExpression identifierRegex(R"(^[a-zA-Z_][a-zA-Z0-9_]*)");
-    QRegularExpression numberRegex(R"(^\d+)");
-    QRegularExpression stringRegex(R"(^"[^"]*")");
-    QRegularExpression operatorRegex(R"(^(\+\+|--))");
-    QRegularExpression comparisonRegex(R"(^[<>=])");
-    QRegularExpression assignmentRegex(R"(^:=)");
-    QRegularExpression specialCharRegex(R"(^[\(\)\{\};])");
-    QStringList keywords = {"for", "do"};
+    // Пока запись продолжается, перекомпиляция откладывается, но не дольше MaxRefreshDelayMs
+    if (changeTimer.elapsed() >= MaxRefreshDelayMs) {
+        debounceTimer->stop();
+        onRecompile();
+    } else {
+        debounceTimer->start();
+    }
+}
 
-    for (int i = 0; i < lines.size(); ++i) {
-        QString line = lines[i];
-        int column = 0;
+void MainWindow::onRecompile()
+{
+    if (compileWatcher->isRunning()) {
+        recompilePending = true;
+        return;
+    }
 
-        while (column < line.length()) {
-            QStringRef subLine = line.midRef(column).trimmed();
+    refreshTimer = changeTimer;
+    changeTimer.invalidate();
+
+    // Файл, сохранённый удалением и созданием заново, мог выпасть из наблюдения и в onFileChanged
+    // ещё не существовать; пока его нет, проверка повторяется
+    if (watchCheckBox->isChecked() && !fileWatcher->files().contains(sourceFileName)) {
+        if (!QFile::exists(sourceFileName)) {
+            ui->statusbar->showMessage(QString("Файл %1 не найден; наблюдение возобновится, когда он появится").arg(sourceFileName));
+            const int generation = loadGeneration;
+            QTimer::singleShot(MaxRefreshDelayMs, this, [this, generation]() {
+                if (generation == loadGeneration && watchCheckBox->isChecked()) {
+                    onRecompile();
+                }
+            });
+            return;
+        }
+        fileWatcher->addPath(sourceFileName);
+    }
 
-            if (subLine.startsWith("//")) {
-                break;
-            }
+    QByteArray data;
+    if (!readSource(sourceFileName, data)) {
+        ui->statusbar->showMessage(QString("Не удалось прочитать файл %1").arg(sourceFileName));
+        return;
+    }
 
-            if (line[column].isSpace()) {
-                column++;
-                continue;
-            }
+    QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+    if (hash == sourceHash) {
+        ui->statusbar->showMessage("Содержимое файла не изменилось");
+        return;
+    }
 
-            bool keywordMatched = false;
-            for (const QString &keyword : keywords) {
-                if (subLine.startsWith(keyword) &&
-                    (subLine.size() == keyword.length() || !subLine[keyword.length()].isLetterOrNumber())) {
-                    addLexemToTable("Ключевое слово", keyword, i + 1, column + 1);
-                    tokens.append({Keyword, keyword, i + 1, column + 1});
-                    column += keyword.length();
-                    keywordMatched = true;
-                    break;
-                }
-            }
-            if (keywordMatched) {
-                continue;
-            }
+    pendingSource = QString::fromUtf8(data);
+    pendingHash = hash;
+    startCompile();
+}
 
-            QRegularExpressionMatch match = stringRegex.match(line.mid(column));
-            if (match.hasMatch()) {
-                addLexemToTable("Строковая константа", match.captured(), i + 1, column + 1);
-                tokens.append({StringConstant, match.captured(), i + 1, column + 1});
-                column += match.capturedLength();
-                continue;
-            }
+void MainWindow::startCompile()
+{
+    compileGeneration = loadGeneration;
+
+    const QString source = pendingSource;
+    const bool streaming = streamingCheckBox->isChecked();
+    const bool profiling = profileCheckBox->isChecked();
+    const TriadProfile profile = loadProfile();
+    compileWatcher->setFuture(QtConcurrent::run([source, streaming, profiling, profile]() {
+        Compiler compiler;
+        compiler.setProfiling(profiling, profile);
+        return compiler.compile(source, streaming);
+    }));
+}
 
-            match = assignmentRegex.match(line.mid(column));
-            if (match.hasMatch()) {
-                addLexemToTable("Знак присваивания", match.captured(), i + 1, column + 1);
-                tokens.append({Assignment, match.captured(), i + 1, column + 1});
-                column += match.capturedLength();
-                continue;
-            }
+void MainWindow::onCompileFinished()
+{
+    // Результат устарел, если за время компиляции был выбран другой файл: компилируется уже он
+    if (compileGeneration != loadGeneration) {
+        startCompile();
+        return;
+    }
 
-            match = operatorRegex.match(line.mid(column));
-            if (match.hasMatch()) {
-                addLexemToTable("Арифметический оператор", match.captured(), i + 1, column + 1);
-                tokens.append({Operator, match.captured(), i + 1, column + 1});
-                column += match.capturedLength();
-                continue;
-            }
+    CompileResult result = compileWatcher->result();
+    sourceHash = pendingHash;
+    saveProfile(result);
 
-            match = comparisonRegex.match(line.mid(column));
-            if (match.hasMatch()) {
-                addLexemToTable("Оператор сравнения", match.captured(), i + 1, column + 1);
-                tokens.append({Comparison, match.captured(), i + 1, column + 1});
-                column += match.capturedLength();
-                continue;
-            }
+    if (loadCompile) {
+        loadCompile = false;
+        ui->statusbar->clearMessage();
+        showResult(result, true);
 
-            match = numberRegex.match(line.mid(column));
-            if (match.hasMatch()) {
-                addLexemToTable("Число", match.captured(), i + 1, column + 1);
-                tokens.append({Number, match.captured(), i + 1, column + 1});
-                column += match.capturedLength();
-                continue;
-            }
+        if (result.parsed) {
+            QMessageBox::information(this, "Синтаксический анализ", "Анализ успешно завершен!");
+        } else {
+            QMessageBox::critical(this, "Синтаксический анализ", QString("Ошибка синтаксического анализа: %1").arg(syntaxErrorText(result.syntaxError)));
+        }
+    } else {
+        loadDocument(pendingSource, textEdit->verticalScrollBar()->value());
 
-            match = identifierRegex.match(line.mid(column));
-            if (match.hasMatch()) {
-                QString tokenValue = match.captured();
+        QStringList refreshed;
+        refreshed << "Исходный текст";
+        refreshed << showResult(result, false);
 
-                if (keywords.contains(tokenValue)) {
-                    addLexemToTable("Ключевое слово", tokenValue, i + 1, column + 1);
-                    tokens.append({Keyword, tokenValue, i + 1, column + 1});
-                } else {
-                    addLexemToTable("Идентификатор", tokenValue, i + 1, column + 1);
-                    tokens.append({Identifier, tokenValue, i + 1, column + 1});
-                }
+        QString message = QString("Перекомпилировано за %1 мс, обновлено: %2")
+                .arg(refreshTimer.isValid() ? refreshTimer.elapsed() : 0)
+                .arg(refreshed.join(", "));
+        if (!result.parsed) {
+            message += QString("; ошибка синтаксического анализа: %1").arg(syntaxErrorText(result.syntaxError));
+        }
+        ui->statusbar->showMessage(message);
+    }
 
-                column += match.capturedLength();
-                continue;
-            }
+    if (recompilePending) {
+        recompilePending = false;
+        onRecompile();
+    }
+}
 
-            match = specialCharRegex.match(line.mid(column));
-            if (match.hasMatch()) {
-                addLexemToTable("Специальный символ", match.captured(), i + 1, column + 1);
-                tokens.append({SpecialChar, match.captured(), i + 1, column + 1});
-                column += match.capturedLength();
-                continue;
-            }
+void MainWindow::onBatchCompileFiles()
+{
+    QStringList fileNames = QFileDialog::getOpenFileNames(this, "Исходные тексты", "", "Текстовые файлы (*.txt);;Все файлы (*.*)");
+    if (fileNames.isEmpty())
+        return;
 
-            addLexemToTable("Error", QString("Неопознанный символ: %1").arg(line[column]), i + 1, column + 1);
-            tokens.append({Error, QString("Неопознанный символ: %1").arg(line[column]), i + 1, column + 1});
-            column++;
-        }
+    startBatch(fileNames);
+}
+
+void MainWindow::onBatchCompileDirectory()
+{
+    QString directory = QFileDialog::getExistingDirectory(this, "Каталог с исходными текстами");
+    if (directory.isEmpty())
+        return;
+
+    QStringList fileNames = BatchCompiler::collectFiles(directory, {"*.txt"});
+    if (fileNames.isEmpty()) {
+        QMessageBox::information(this, "Пакетная компиляция", "В каталоге нет файлов *.txt");
+        return;
     }
 
-    return tokens;
+    startBatch(fileNames);
 }
 
-void MainWindow::addLexemToTable(const QString &type, const QString &value, int line, int column)
+void MainWindow::startBatch(const QStringList &fileNames)
 {
-    int row = lexicalTable->rowCount();
-    lexicalTable->insertRow(row);
-    lexicalTable->setItem(row, 0, new QTableWidgetItem(type));
-    lexicalTable->setItem(row, 1, new QTableWidgetItem(value));
-    lexicalTable->setItem(row, 2, new QTableWidgetItem(QString::number(line)));
-    lexicalTable->setItem(row, 3, new QTableWidgetItem(QString::number(column)));
+    batchButton->setEnabled(false);
+    batchDirectoryButton->setEnabled(false);
+    ui->statusbar->showMessage(QString("Пакетная компиляция: %1 файлов...").arg(fileNames.size()));
+    batchWatcher->setFuture(QtConcurrent::run([fileNames]() {
+        BatchCompiler compiler;
+        return compiler.compile(fileNames);
+    }));
+}
 
-    lexicalTable->item(row, 1)->setTextAlignment(Qt::AlignCenter);
-    lexicalTable->item(row, 2)->setTextAlignment(Qt::AlignCenter);
-    lexicalTable->item(row, 3)->setTextAlignment(Qt::AlignCenter);
+void MainWindow::onBatchFinished()
+{
+    BatchResult result = batchWatcher->result();
+    batchButton->setEnabled(true);
+    batchDirectoryButton->setEnabled(true);
+    displayBatch(result);
+    ui->tabWidget->setCurrentIndex(ui->tabWidget->count() - 1);
+
+    qint64 totalNs = 0;
+    for (const BatchEntry &entry : result.entries) {
+        totalNs += entry.elapsedNs;
+    }
+    ui->statusbar->showMessage(QString("Файлов: %1, с ошибками: %2; %3 мс на %4 потоках (суммарно по файлам %5 мс, %6 файлов/с)")
+                               .arg(result.entries.size())
+                               .arg(result.failedCount())
+                               .arg(result.elapsedMs)
+                               .arg(result.threads)
+                               .arg(totalNs / 1000000)
+                               .arg(result.elapsedMs > 0 ? result.entries.size() * 1000 / result.elapsedMs : result.entries.size()));
 }
 
-bool MainWindow::parse(const QList<Token> &tokens) {
-    syntaxTree.clear();
-    syntaxError = Token{Error, NULL, 0, 0};
+bool MainWindow::readSource(const QString &fileName, QByteArray &data)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    data = file.readAll();
+    file.close();
+    return true;
+}
 
-    TreeNode root = {"node", "S", QVector<TreeNode>()};
-    int index = 0;
-    if (parseS(tokens, index, root) && index == tokens.size()) {
-        syntaxTree = root;
-        return true;
+void MainWindow::loadDocument(const QString &text, int scroll)
+{
+    // Большой файл вставляется частями между событиями, чтобы окно не замирало;
+    // новая загрузка просто подменяет догружаемый текст
+    documentText = text;
+    documentOffset = 0;
+    restoreScroll = scroll;
+    textEdit->clear();
+
+    onAppendDocumentChunk();
+    if (documentOffset < documentText.size()) {
+        documentTimer->start();
     }
-    return false;
 }
 
-bool MainWindow::parseS(const QList<Token> &tokens, int &index, TreeNode &treeNode) {
-    if (parseF(tokens, index, treeNode)) {
-        if (index < tokens.size() && tokens[index].value == ";") {
-            treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-            index++;
-            return true;
-        }
+void MainWindow::onAppendDocumentChunk()
+{
+    const int length = documentText.size();
+    int end = length;
+    if (length - documentOffset > DocumentChunkSize) {
+        // Часть заканчивается на границе строки, иначе блок подсветился бы по неполному тексту
+        end = CharScan::findChar(documentText.constData(), documentOffset + DocumentChunkSize, length, '\n');
+        end = end < length ? end + 1 : length;
     }
-    if (syntaxError.value == NULL) {
-        syntaxError = tokens[index];
+
+    QTextCursor cursor(textEdit->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(documentText.mid(documentOffset, end - documentOffset));
+    documentOffset = end;
+
+    QScrollBar *scrollBar = textEdit->verticalScrollBar();
+    if (restoreScroll >= 0 && (scrollBar->maximum() >= restoreScroll || documentOffset == length)) {
+        scrollBar->setValue(restoreScroll);
+        restoreScroll = -1;
+    }
+
+    if (documentOffset == length) {
+        documentTimer->stop();
+        documentText.clear();
+        documentOffset = 0;
     }
-    return false;
 }
 
-bool MainWindow::parseF(const QList<Token> &tokens, int &index, TreeNode &treeNode) {
-    if (index < tokens.size() && tokens[index].value == "for") {
-        TreeNode child = {"node", "F", QVector<TreeNode>()};
-
-        child.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-        index++;
-        if (index < tokens.size() && tokens[index].value == "(") {
-            child.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-            index++;
-
-            TreeNode tNode = {"node", "T", QVector<TreeNode>()};
-            if (parseT(tokens, index, tNode)) {
-                child.children.append(tNode);
-                if (index < tokens.size() && tokens[index].value == ")") {
-                    child.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-                    index++;
-                    if (index < tokens.size() && tokens[index].value == "do") {
-                        child.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-                        index++;
-
-                        if (parseG(tokens, index, child)) {
-                            treeNode.children.append(child);
-                            return true;
-                        }
-                    }
-                }
-            }
-        }
-    } else if (parseG(tokens, index, treeNode)) {
-        return true;
+TriadProfile MainWindow::loadProfile() const
+{
+    // Профиль лежит рядом с исходным текстом; устаревший отбрасывается компилятором по ключу
+    TriadProfile profile;
+    if (profileCheckBox->isChecked()) {
+        profile.load(sourceFileName + ".profile");
     }
-    if (syntaxError.value == NULL) {
-        syntaxError = tokens[index];
+    return profile;
+}
+
+void MainWindow::saveProfile(const CompileResult &result)
+{
+    if (result.profile.isEmpty()) {
+        return;
+    }
+    if (!result.profile.save(sourceFileName + ".profile")) {
+        ui->statusbar->showMessage(QString("Не удалось сохранить профиль %1.profile").arg(sourceFileName));
     }
-    return false;
 }
 
-bool MainWindow::parseG(const QList<Token> &tokens, int &index, TreeNode &treeNode) {
-    if (index < tokens.size() && tokens[index].value == "for") {
-        if (parseF(tokens, index, treeNode)) {
-            return true;
-        }
-        if (syntaxError.value == NULL) {
-            syntaxError = tokens[index];
-        }
-        return false;
-    } else if (index + 5 < tokens.size() && tokens[index + 1].type == Assignment && tokens[index + 5].type == Assignment) {
-        TreeNode fNode1 = {"node", "F", QVector<TreeNode>()};
-        if (parseAssignment(tokens, index, fNode1)) {
-            treeNode.children.append(fNode1);
-            if (index < tokens.size() && tokens[index].value == ";") {
-                treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-                index++;
-
-                TreeNode fNode2 = {"node", "F", QVector<TreeNode>()};
-                if (index + 5 < tokens.size() && tokens[index + 1].type == Assignment && tokens[index + 5].type == Assignment) {
-                    return parseG(tokens, index, treeNode);
-                } else {
-                    if (parseAssignment(tokens, index, fNode2)) {
-                        treeNode.children.append(fNode2);
-                        return true;
-                    }
-                }
-            }
-        }
+static bool sameLexemes(const QList<Token> &a, const QList<Token> &b)
+{
+    if (a.size() != b.size()) {
         return false;
     }
-    TreeNode fNode = {"node", "F", QVector<TreeNode>()};
-    if (parseAssignment(tokens, index, fNode)) {
-        treeNode.children.append(fNode);
-        return true;
+    for (int i = 0; i < a.size(); ++i) {
+        if (a[i].type != b[i].type || a[i].value != b[i].value) {
+            return false;
+        }
     }
-    return false;
+    return true;
 }
 
-bool MainWindow::parseT(const QList<Token> &tokens, int &index, TreeNode &treeNode) {
-    if (tokens[index].value != ";") {
-
-        if (parseF(tokens, index, treeNode)) {
-            if (tokens[index].value == ";") {
-                treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-                index++;
-
-                TreeNode eNode = {"node", "E", QVector<TreeNode>()};
-                if (parseE(tokens, index, eNode)) {
-                    treeNode.children.append(eNode);
-                    if (tokens[index].value == ";") {
-                        treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-                        index++;
-
-                        if (tokens[index].value == ")") {
-                            return true;
-                        } else {
-                            return parseF(tokens, index, treeNode);
-                        }
-                    }
-                }
-            }
-        }
-    } else {
-        if (tokens[index].value == ";") {
-            treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-            index++;
-
-            TreeNode eNode = {"node", "E", QVector<TreeNode>()};
-            if (parseE(tokens, index, eNode)) {
-                treeNode.children.append(eNode);
-                if (tokens[index].value == ";") {
-                    treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-                    index++;
-
-                    if (tokens[index].value == ")") {
-                        return true;
-                    } else {
-                        return parseF(tokens, index, treeNode);
-                    }
-                }
-            }
-        }
+QStringList MainWindow::showResult(const CompileResult &result, bool force)
+{
+    QStringList refreshed;
+
+    if (force || result.tokens != lastResult.tokens) {
+        displayLexemes(result.tokens);
+        highlighter->setTokens(result.tokens);
+        refreshed << "Лексический анализатор";
     }
-    if (syntaxError.value == NULL) {
-        syntaxError = tokens[index];
+    highlighter->setSyntaxError(result.parsed ? Token() : result.syntaxError);
+
+    // При ошибке разбора остальные вкладки сохраняют последний успешный результат
+    if (!result.parsed) {
+        lastResult.tokens = result.tokens;
+        lastResult.parsed = false;
+        return refreshed;
     }
-    return false;
-}
 
-bool MainWindow::parseE(const QList<Token> &tokens, int &index, TreeNode &treeNode) {
-    if (index < tokens.size() && tokens[index].type == Identifier) {
-        treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-        index++;
-        if (index < tokens.size() && (tokens[index].value == "<" || tokens[index].value == ">" || tokens[index].value == "=")) {
-            treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-            index++;
-            if (index < tokens.size() && tokens[index].type == Number) {
-                treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-                index++;
-                return true;
-            }
-        }
+    if (force || !lastResult.parsed || !sameLexemes(result.tokens, lastResult.tokens)) {
+        displayPrecedenceMatrix(result.tokens);
+        refreshed << "Матрица предшествования";
     }
-    if (syntaxError.value == NULL) {
-        syntaxError = tokens[index];
+
+    if (force || !(result.syntaxTree == lastResult.syntaxTree)) {
+        displaySyntaxTree(result.syntaxTree);
+        refreshed << "Синтаксическое дерево";
     }
-    return false;
+
+    if (force || result.baseTriads != lastResult.baseTriads || result.foldedTriads != lastResult.foldedTriads ||
+        result.optimizedTriads != lastResult.optimizedTriads || result.profileReport != lastResult.profileReport) {
+        displayTriads(baseTriadsList, result.baseTriads);
+        displayTriads(foldingTriadsList, result.foldedTriads);
+        displayTriads(resultTriadsList, result.optimizedTriads);
+        profileList->clear();
+        profileList->addItems(result.profileReport);
+        profileList->setVisible(!result.profileReport.isEmpty());
+        refreshed << "Триады";
+    }
+
+    if (force || result.ssaListing != lastResult.ssaListing) {
+        ssaList->clear();
+        ssaList->addItems(result.ssaListing);
+        refreshed << "Граф управления (SSA)";
+    }
+
+    lastResult = result;
+    return refreshed;
 }
 
-bool MainWindow::parseAssignment(const QList<Token> &tokens, int &index, TreeNode &treeNode) {
-    if (index < tokens.size() && tokens[index].type == Identifier) {
-        treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-        index++;
-        if(index < tokens.size() && tokens[index].type == Operator) {
-            treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-            index++;
-            return true;
-        }
-        if (index < tokens.size() && tokens[index].value == ":=") {
-            treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-            index++;
-            if (index < tokens.size() && (tokens[index].type == Identifier || tokens[index].type == StringConstant || tokens[index].type == Number)) {
-                treeNode.children.append({"lexeme", tokens[index].value, QVector<TreeNode>()});
-                index++;
-                return true;
-            }
-        }
+void MainWindow::displayLexemes(const QList<Token> &tokens)
+{
+    // Таблица на сотни тысяч строк строилась бы дольше самой компиляции
+    // qMin принимает ссылки, а у MaxTableLexemes нет определения вне класса
+    const int limit = MaxTableLexemes;
+    const int shown = qMin(tokens.size(), limit);
+
+    lexicalTable->setUpdatesEnabled(false);
+    lexicalTable->clearSpans();
+    lexicalTable->setRowCount(0);
+    for (int i = 0; i < shown; ++i) {
+        addLexemToTable(tokenTypeName(tokens[i].type), tokens[i].value, tokens[i].line, tokens[i].column);
     }
-    if (syntaxError.value == NULL) {
-        syntaxError = tokens[index];
+    if (shown < tokens.size()) {
+        int row = lexicalTable->rowCount();
+        lexicalTable->insertRow(row);
+        lexicalTable->setItem(row, 0, new QTableWidgetItem(QString("Показаны первые %1 лексем из %2").arg(shown).arg(tokens.size())));
+        lexicalTable->setSpan(row, 0, 1, lexicalTable->columnCount());
     }
-    return false;
+    lexicalTable->setUpdatesEnabled(true);
+}
+
+void MainWindow::addLexemToTable(const QString &type, const QString &value, int line, int column)
+{
+    int row = lexicalTable->rowCount();
+    lexicalTable->insertRow(row);
+    lexicalTable->setItem(row, 0, new QTableWidgetItem(type));
+    lexicalTable->setItem(row, 1, new QTableWidgetItem(value));
+    lexicalTable->setItem(row, 2, new QTableWidgetItem(QString::number(line)));
+    lexicalTable->setItem(row, 3, new QTableWidgetItem(QString::number(column)));
+
+    lexicalTable->item(row, 1)->setTextAlignment(Qt::AlignCenter);
+    lexicalTable->item(row, 2)->setTextAlignment(Qt::AlignCenter);
+    lexicalTable->item(row, 3)->setTextAlignment(Qt::AlignCenter);
 }
 
-void MainWindow::syntaxAnalysis(const QList<Token> &tokens)
+void MainWindow::displayPrecedenceMatrix(const QList<Token> &tokens)
 {
+    // Матрица растёт как квадрат числа лексем, поэтому строится по началу текста
+    const int limit = MaxMatrixLexemes;
+    const int shown = qMin(tokens.size(), limit);
+    if (shown < tokens.size()) {
+        ui->statusbar->showMessage(QString("Матрица предшествования построена по первым %1 лексемам из %2").arg(shown).arg(tokens.size()));
+    }
+
     QList<QString> lexemes;
     QList<QString> lexemesTypes;
-    for (const Token &token : tokens) {
+    for (int i = 0; i < shown; ++i) {
+        const Token &token = tokens[i];
         QString type = token.type == 0 ? "id" : token.type == 2 ? "num" : token.type == 3 ? "str" : "def";
         QString value = token.value;
 
@@ -487,10 +622,13 @@ void MainWindow::syntaxAnalysis(const QList<Token> &tokens)
             }
         }
     }
+}
 
+void MainWindow::displaySyntaxTree(const TreeNode &tree)
+{
     syntaxTreeWidget->clear();
-    if (!syntaxTree.type.isEmpty()) {
-        buildSyntaxTreeWidget(syntaxTree, syntaxTreeWidget->invisibleRootItem());
+    if (!tree.type.isEmpty()) {
+        buildSyntaxTreeWidget(tree, syntaxTreeWidget->invisibleRootItem());
         syntaxTreeWidget->expandAll();
     }
 }
@@ -504,185 +642,49 @@ void MainWindow::buildSyntaxTreeWidget(const TreeNode &node, QTreeWidgetItem *pa
     }
 }
 
-QVector<Triad> MainWindow::generateTriads(const TreeNode& node, int& counter, QMap<QString, int>& triadCache) {
-    QVector<Triad> triads;
-
-    if (node.type == "lexeme") {
-        return triads;
-    }
-
-    if (node.value == "F" && !node.children.isEmpty()) {
-        if (node.children.size() > 2 && node.children[1].value == ":=") {
-            QString leftOperand = node.children[0].value;
-            QString rightOperand = node.children[2].value;
-
-            triads.append(Triad(":=", leftOperand, rightOperand));
-            triads.last().index = ++counter;
-        }
-        else if (node.children.size() > 4 && node.children[0].value == "for") {
-            TreeNode tNode = node.children[2];
-
-            QVector<Triad> tTriads = generateTriads(tNode, counter, triadCache);
-            triads.append(tTriads);
-
-            int conditionIndex = counter - tTriads.size() + 1;
-
-            QVector<Triad> bodyTriads;
-            for (const TreeNode& child : node.children) {
-                if (child.value == "F") {
-                    QVector<Triad> nestedBodyTriads = generateTriads(child, counter, triadCache);
-                    bodyTriads.append(nestedBodyTriads);
-                }
-            }
-
-            triads.append(bodyTriads);
-
-            triads.append(Triad("for",
-                                QString("^%1").arg(conditionIndex),
-                                QString("^%1").arg(counter)));
-            triads.last().index = ++counter;
-        }
-        else if (node.children.size() > 2 && (node.children[1].value == "++" || node.children[1].value == "--")) {
-            QString leftOperand = node.children[0].value;
-            QString rightOperand = "1";
-
-            triads.append(Triad(node.children[1].value == "++" ? "+" : "-", leftOperand, rightOperand));
-            triads.last().index = ++counter;
-        }
-    }
-    else if (node.value == "T") {
-        for (const TreeNode& child : node.children) {
-            QVector<Triad> childTriads = generateTriads(child, counter, triadCache);
-            triads.append(childTriads);
-        }
-    }
-    else if (node.value == "E" && node.children.size() == 3) {
-        QString leftOperand = node.children[0].value;
-        QString operation = node.children[1].value;
-        QString rightOperand = node.children[2].value;
-
-        triads.append(Triad(operation, leftOperand, rightOperand));
-        triads.last().index = ++counter;
-    }
-
-    for (auto& triad : triads) {
-        if (triad.index == 0) {
-            triad.index = ++counter;
-        }
+void MainWindow::displayTriads(QListWidget *widget, const QVector<Triad>& triads) {
+    widget->clear();
+    for (const auto& triad : triads) {
+        widget->addItem(QString::number(triad.index) + ". " + triad.toString());
     }
-
-    return triads;
 }
 
-QVector<Triad> MainWindow::foldTriads(const QVector<Triad>& inputTriads) {
-    QVector<Triad> foldedTriads;
-    QMap<QString, QString> lastAssignment;
-
-    for (const Triad& triad : inputTriads) {
-        Triad newTriad = triad;
-
-        if (newTriad.operation == ":=") {
-            QString variable = newTriad.operand1;
-            QString value = newTriad.operand2;
-
-            if (lastAssignment.contains(value)) {
-                QString assignedValue = lastAssignment[value];
-
-                bool isConst = assignedValue.toInt(nullptr, 10);
-                if (isConst) {
-                    value = assignedValue;
-                }
-            }
-
-            lastAssignment[variable] = value;
-
-            newTriad.operand2 = value;
-        }
-
-        foldedTriads.append(newTriad);
-    }
-
-    for (int i = 0; i < foldedTriads.size(); ++i) {
-        foldedTriads[i].index = i + 1;
+void MainWindow::displayBatch(const BatchResult &result)
+{
+    // Самые долгие файлы — в начале таблицы
+    QVector<const BatchEntry *> entries;
+    for (const BatchEntry &entry : result.entries) {
+        entries.append(&entry);
     }
-
-    return foldedTriads;
-}
-
-QVector<Triad> MainWindow::removeRedundantTriads(const QVector<Triad>& inputTriads) {
-    QVector<Triad> optimizedTriads;
-    QSet<QString> usedVariables;
-    QMap<QString, int> lastAssignmentIdx;
-    QMap<int, int> indexMapping;
-
-    int currentIndex = 1;
-
-    for (int i = 0; i < inputTriads.size(); ++i) {
-        const Triad& triad = inputTriads[i];
-
-        if (triad.operation == ":=") {
-            QString variable = triad.operand1;
-
-            if (lastAssignmentIdx.contains(variable) && !usedVariables.contains(variable)) {
-                optimizedTriads.removeAt(lastAssignmentIdx[variable]);
-            }
-
-            lastAssignmentIdx[variable] = optimizedTriads.size();
+    std::stable_sort(entries.begin(), entries.end(), [](const BatchEntry *a, const BatchEntry *b) {
+        return a->elapsedNs > b->elapsedNs;
+    });
+
+    batchTable->setUpdatesEnabled(false);
+    batchTable->setRowCount(entries.size());
+    for (int row = 0; row < entries.size(); ++row) {
+        const BatchEntry &entry = *entries[row];
+
+        QString status;
+        if (!entry.readable) {
+            status = "Не удалось открыть файл";
+        } else if (entry.parsed) {
+            status = "Успешно";
         } else {
-            if (!triad.operand1.isEmpty()) {
-                usedVariables.insert(triad.operand1);
-            }
-            if (!triad.operand2.isEmpty()) {
-                usedVariables.insert(triad.operand2);
-            }
+            status = syntaxErrorText(entry.syntaxError);
+            status[0] = status[0].toUpper();
         }
 
-        optimizedTriads.append(triad);
-        indexMapping[i + 1] = currentIndex++;
-    }
+        batchTable->setItem(row, 0, new QTableWidgetItem(entry.fileName));
+        batchTable->setItem(row, 1, new QTableWidgetItem(status));
+        batchTable->setItem(row, 2, new QTableWidgetItem(QString::number(entry.elapsedNs / 1000000.0, 'f', 3)));
+        batchTable->setItem(row, 3, new QTableWidgetItem(QString::number(entry.triadCount)));
 
-    for (Triad& triad : optimizedTriads) {
-        if (triad.operand1.startsWith("^")) {
-            int oldIndex = triad.operand1.midRef(1).toInt();
-            if (indexMapping.contains(oldIndex)) {
-                triad.operand1 = QString("^%1").arg(indexMapping[oldIndex]);
-            }
-        }
-        if (triad.operand2.startsWith("^")) {
-            int oldIndex = triad.operand2.midRef(1).toInt();
-            if (indexMapping.contains(oldIndex)) {
-                triad.operand2 = QString("^%1").arg(indexMapping[oldIndex]);
-            }
+        if (!entry.readable || !entry.parsed) {
+            batchTable->item(row, 1)->setForeground(Qt::red);
         }
+        batchTable->item(row, 2)->setTextAlignment(Qt::AlignCenter);
+        batchTable->item(row, 3)->setTextAlignment(Qt::AlignCenter);
     }
-
-    for (int i = 0; i < optimizedTriads.size(); ++i) {
-        optimizedTriads[i].index = i + 1;
-    }
-
-    return optimizedTriads;
-}
-
-
-void MainWindow::displayTriads(QListWidget *widget, const QVector<Triad>& triads) {
-    widget->clear();
-    for (const auto& triad : triads) {
-        widget->addItem(QString::number(triad.index) + ". " + triad.toString());
-    }
-}
-
-void MainWindow::generateCode() {
-    int counter = 0;
-    QMap<QString, int> triadCache;
-    TreeNode rootNode = syntaxTree.children[0];
-
-    QVector<Triad> baseTriads = generateTriads(rootNode, counter, triadCache);
-    displayTriads(baseTriadsList, baseTriads);
-
-
-    QVector<Triad> collapsedTriads = foldTriads(baseTriads);
-    displayTriads(foldingTriadsList, collapsedTriads);
-
-    QVector<Triad> optimizedTriads = removeRedundantTriads(collapsedTriads);
-    displayTriads(resultTriadsList, optimizedTriads);
+    batchTable->setUpdatesEnabled(true);
 }
@@ -1,6 +1,9 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include "batchcompiler.h"
+#include "compiler.h"
+#include "tokenhighlighter.h"
 #include "token.h"
 #include "treeNode.h"
 #include "triad.h"
@@ -16,6 +19,11 @@
 #include <QHeaderView>
 #include <QTreeWidget>
 #include <QListWidget>
+#include <QCheckBox>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -31,6 +39,14 @@ public:
 
 private slots:
     void onLoadFile();
+    void onWatchToggled(bool enabled);
+    void onFileChanged(const QString &path);
+    void onRecompile();
+    void onCompileFinished();
+    void onAppendDocumentChunk();
+    void onBatchCompileFiles();
+    void onBatchCompileDirectory();
+    void onBatchFinished();
 
 private:
     Ui::MainWindow *ui;
@@ -39,33 +55,63 @@ private:
     QTableWidget *precedenceMatrixTable;
     QTreeWidget *syntaxTreeWidget;
     QPushButton *loadFileButton;
-    TreeNode syntaxTree;
-    Token syntaxError;
+    QPushButton *batchButton;
+    QPushButton *batchDirectoryButton;
+    QCheckBox *streamingCheckBox;
+    QCheckBox *watchCheckBox;
+    QCheckBox *profileCheckBox;
     QListWidget *baseTriadsList;
     QListWidget *foldingTriadsList;
     QListWidget *resultTriadsList;
+    QListWidget *profileList;
+    QListWidget *ssaList;
+    QTableWidget *batchTable;
+    TokenHighlighter *highlighter;
 
-    QList<Token> lexicalAnalysis(const QString &text);
-    void syntaxAnalysis(const QList<Token> &tokens);
+    QString sourceFileName;
+    QByteArray sourceHash;
+    QString pendingSource;
+    QByteArray pendingHash;
+    CompileResult lastResult;
 
-    void addLexemToTable(const QString& type, const QString& value, int line, int column);
+    QFileSystemWatcher *fileWatcher;
+    QTimer *debounceTimer;
+    QElapsedTimer changeTimer;
+    QElapsedTimer refreshTimer;
+    QFutureWatcher<CompileResult> *compileWatcher;
+    bool recompilePending;
+    bool loadCompile;            // Идёт компиляция только что выбранного файла
+    int loadGeneration;
+    int compileGeneration;
 
-    bool parse(const QList<Token> &tokens);
-    bool parseS(const QList<Token> &tokens, int &index, TreeNode &treeNode);
-    bool parseF(const QList<Token> &tokens, int &index, TreeNode &treeNode);
-    bool parseG(const QList<Token> &tokens, int &index, TreeNode &treeNode);
-    bool parseT(const QList<Token> &tokens, int &index, TreeNode &treeNode);
-    bool parseE(const QList<Token> &tokens, int &index, TreeNode &treeNode);
-    bool parseAssignment(const QList<Token> &tokens, int &index, TreeNode &treeNode);
+    QString documentText;        // Текст, догружаемый в редактор частями
+    int documentOffset;
+    int restoreScroll;
+    QTimer *documentTimer;
 
-    void buildSyntaxTreeWidget(const TreeNode &node, QTreeWidgetItem *parent);
+    QFutureWatcher<BatchResult> *batchWatcher;
+
+    static const int DebounceMs = 150;
+    static const int MaxRefreshDelayMs = 1000;
+    static const int DocumentChunkSize = 256 * 1024;
+    static const int MaxTableLexemes = 20000;
+    static const int MaxMatrixLexemes = 200;
 
-    QVector<Triad> generateTriads(const TreeNode& node, int& counter, QMap<QString, int>& triadCache);
-    QVector<Triad> foldTriads(const QVector<Triad>& inputTriads);
-    QVector<Triad> removeRedundantTriads(const QVector<Triad>& triads);
+    bool readSource(const QString &fileName, QByteArray &data);
+    void startCompile();
+    TriadProfile loadProfile() const;
+    void saveProfile(const CompileResult &result);
+    void loadDocument(const QString &text, int scroll);
+    void startBatch(const QStringList &fileNames);
+    QStringList showResult(const CompileResult &result, bool force);
 
+    void displayLexemes(const QList<Token> &tokens);
+    void addLexemToTable(const QString& type, const QString& value, int line, int column);
+    void displayPrecedenceMatrix(const QList<Token> &tokens);
+    void displaySyntaxTree(const TreeNode &tree);
+    void buildSyntaxTreeWidget(const TreeNode &node, QTreeWidgetItem *parent);
     void displayTriads(QListWidget *widget, const QVector<Triad>& triads);
-    void generateCode();
+    void displayBatch(const BatchResult &result);
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,300 @@
+#include "profiler.h"
+#include "cfg.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QTextStream>
+
+#include <algorithm>
+
+bool TriadProfile::save(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "key " << key << "\n";
+    out << "steps " << steps << "\n";
+    out << "iterations " << iterations << "\n";
+    out << "complete " << (complete ? 1 : 0) << "\n";
+    out << "triads " << triadCounts.size() << "\n";
+    for (int i = 0; i < triadCounts.size(); ++i) {
+        if (triadCounts[i] != 0) {
+            out << "t " << i << " " << triadCounts[i] << "\n";
+        }
+    }
+    out << "loops " << loopCounts.size() << "\n";
+    for (int i = 0; i < loopCounts.size(); ++i) {
+        out << "l " << i << " " << loopCounts[i] << "\n";
+    }
+    return true;
+}
+
+bool TriadProfile::load(const QString &fileName)
+{
+    *this = TriadProfile();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    TriadProfile profile;
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        const QStringList fields = in.readLine().split(' ');
+        if (fields.size() == 2) {
+            if (fields[0] == "key") {
+                profile.key = fields[1].toLatin1();
+            } else if (fields[0] == "steps") {
+                profile.steps = fields[1].toLongLong();
+            } else if (fields[0] == "iterations") {
+                profile.iterations = fields[1].toLongLong();
+            } else if (fields[0] == "complete") {
+                profile.complete = fields[1] == "1";
+            } else if (fields[0] == "triads") {
+                profile.triadCounts.fill(0, fields[1].toInt());
+            } else if (fields[0] == "loops") {
+                profile.loopCounts.fill(0, fields[1].toInt());
+            }
+        } else if (fields.size() == 3) {
+            QVector<qint64> &counts = fields[0] == "t" ? profile.triadCounts : profile.loopCounts;
+            const int index = fields[1].toInt();
+            if ((fields[0] != "t" && fields[0] != "l") || index < 0 || index >= counts.size()) {
+                return false;
+            }
+            counts[index] = fields[2].toLongLong();
+        }
+    }
+
+    if (profile.key.isEmpty()) {
+        return false;
+    }
+    *this = profile;
+    return true;
+}
+
+QByteArray TriadProfile::programKey(const QVector<Triad> &triads)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    for (const Triad &triad : triads) {
+        hash.addData((QString::number(triad.index) + ". " + triad.toString() + "\n").toUtf8());
+    }
+    return hash.result().toHex();
+}
+
+TriadInterpreter::TriadInterpreter(const QVector<Triad> &triads, const QVector<TriadLoop> &loops, const SymbolTable &symbols)
+    : triads(triads), loops(loops), symbols(symbols)
+{
+}
+
+TriadProfile TriadInterpreter::run(qint64 budget, qint64 iterationLimit) const
+{
+    TriadProfile profile;
+    profile.key = TriadProfile::programKey(triads);
+    profile.triadCounts.fill(0, triads.size());
+    profile.loopCounts.fill(0, loops.size());
+
+    int maxIndex = 0;
+    for (const Triad &triad : triads) {
+        maxIndex = qMax(maxIndex, triad.index);
+    }
+    QVector<int> positionOf(maxIndex + 1, -1);
+    for (int i = 0; i < triads.size(); ++i) {
+        if (triads[i].index > 0) {
+            positionOf[triads[i].index] = i;
+        }
+    }
+
+    // Заголовок цикла в графе содержит единственную триаду — условие
+    QVector<int> loopOfCondition(triads.size(), -1);
+    for (int i = 0; i < loops.size(); ++i) {
+        const int condition = loops[i].condition;
+        if (condition > 0 && condition <= maxIndex && positionOf[condition] >= 0) {
+            loopOfCondition[positionOf[condition]] = i;
+        }
+    }
+
+    const ControlFlowGraph cfg(triads, loops);
+    QVector<Value> variables(symbols.size() + 1);
+    QVector<Value> results(triads.size());
+
+    int block = cfg.entry();
+    for (;;) {
+        const BasicBlock &basicBlock = cfg.blocks()[block];
+
+        for (int position : basicBlock.triads) {
+            if (profile.steps >= budget) {
+                return profile;
+            }
+
+            const Triad &triad = triads[position];
+            Value &result = results[position];
+
+            switch (triad.op) {
+            case TriadAssign:
+                result = operand(triad.operand2, triad.reference2, triad.symbol2, variables, results, positionOf);
+                variables[triad.symbol1] = result;
+                break;
+            case TriadAdd:
+            case TriadSubtract: {
+                Value left = operand(triad.operand1, triad.reference1, triad.symbol1, variables, results, positionOf);
+                Value right = operand(triad.operand2, triad.reference2, triad.symbol2, variables, results, positionOf);
+                result = Value();
+                result.number = triad.op == TriadAdd ? left.number + right.number : left.number - right.number;
+                variables[triad.symbol1] = result;
+                break;
+            }
+            case TriadLess:
+            case TriadGreater:
+            case TriadEqual: {
+                Value left = operand(triad.operand1, triad.reference1, triad.symbol1, variables, results, positionOf);
+                Value right = operand(triad.operand2, triad.reference2, triad.symbol2, variables, results, positionOf);
+                result = Value();
+                result.number = compare(triad.op, left, right) ? 1 : 0;
+                break;
+            }
+            case TriadFor:
+                profile.iterations++;
+                break;
+            case TriadNone:
+                break;
+            }
+
+            profile.steps++;
+            profile.triadCounts[position]++;
+        }
+
+        if (iterationLimit >= 0 && profile.iterations >= iterationLimit) {
+            return profile;
+        }
+
+        const QVector<int> &successors = basicBlock.successors;
+        if (successors.isEmpty()) {
+            profile.complete = true;
+            return profile;
+        }
+
+        // У заголовка последователи — [тело, выход]
+        if (basicBlock.loopHeader && successors.size() == 2) {
+            const int condition = basicBlock.triads.first();
+            if (results[condition].number != 0) {
+                if (loopOfCondition[condition] >= 0) {
+                    profile.loopCounts[loopOfCondition[condition]]++;
+                }
+                block = successors[0];
+            } else {
+                block = successors[1];
+            }
+        } else {
+            block = successors[0];
+        }
+    }
+}
+
+TriadInterpreter::Value TriadInterpreter::operand(const QString &text, int reference, int symbol, const QVector<Value> &variables,
+                                                  const QVector<Value> &results, const QVector<int> &positionOf) const
+{
+    if (symbol > 0) {
+        if (symbols.kind(symbol) == StringSymbol) {
+            Value value;
+            value.isNumber = false;
+            value.text = symbols.name(symbol);
+            return value;
+        }
+        return variables[symbol];
+    }
+
+    Value value;
+    if (reference) {
+        if (reference < positionOf.size() && positionOf[reference] >= 0) {
+            return results[positionOf[reference]];
+        }
+        return value;
+    }
+
+    bool isNumber = false;
+    value.number = text.toLongLong(&isNumber);
+    if (!isNumber) {
+        value.isNumber = false;
+        value.text = text;
+    }
+    return value;
+}
+
+bool TriadInterpreter::compare(TriadOp op, const Value &left, const Value &right)
+{
+    int order;
+    if (left.isNumber && right.isNumber) {
+        order = left.number < right.number ? -1 : left.number > right.number ? 1 : 0;
+    } else {
+        const QString a = left.isNumber ? QString::number(left.number) : left.text;
+        const QString b = right.isNumber ? QString::number(right.number) : right.text;
+        order = QString::compare(a, b);
+    }
+
+    switch (op) {
+    case TriadLess:
+        return order < 0;
+    case TriadGreater:
+        return order > 0;
+    default:
+        return order == 0;
+    }
+}
+
+QStringList profileReport(const TriadProfile &profile, const QVector<Triad> &triads, const QVector<TriadLoop> &loops)
+{
+    static const int HotSpotCount = 10;
+
+    QStringList report;
+    report << QString("Профиль: выполнено %1 триад, %2 итераций циклов (%3)")
+              .arg(profile.steps)
+              .arg(profile.iterations)
+              .arg(profile.complete ? "программа завершилась" : "остановлено по бюджету");
+
+    QVector<int> loopOrder;
+    for (int i = 0; i < profile.loopCounts.size() && i < loops.size(); ++i) {
+        if (profile.loopCounts[i] > 0) {
+            loopOrder.append(i);
+        }
+    }
+    std::stable_sort(loopOrder.begin(), loopOrder.end(), [&profile](int a, int b) {
+        return profile.loopCounts[a] > profile.loopCounts[b];
+    });
+    if (!loopOrder.isEmpty()) {
+        report << "Горячие циклы:";
+        for (int i = 0; i < loopOrder.size() && i < HotSpotCount; ++i) {
+            const TriadLoop &loop = loops[loopOrder[i]];
+            report << QString("    for ^%1 (условие ^%2): %3 итераций")
+                      .arg(loop.end)
+                      .arg(loop.condition)
+                      .arg(profile.loopCounts[loopOrder[i]]);
+        }
+    }
+
+    QVector<int> triadOrder;
+    for (int i = 0; i < profile.triadCounts.size() && i < triads.size(); ++i) {
+        if (profile.triadCounts[i] > 0) {
+            triadOrder.append(i);
+        }
+    }
+    std::stable_sort(triadOrder.begin(), triadOrder.end(), [&profile](int a, int b) {
+        return profile.triadCounts[a] > profile.triadCounts[b];
+    });
+    if (!triadOrder.isEmpty()) {
+        report << "Горячие триады:";
+        for (int i = 0; i < triadOrder.size() && i < HotSpotCount; ++i) {
+            const int position = triadOrder[i];
+            report << QString("    %1. %2: %3 (%4%)")
+                      .arg(triads[position].index)
+                      .arg(triads[position].toString())
+                      .arg(profile.triadCounts[position])
+                      .arg(100.0 * profile.triadCounts[position] / qMax<qint64>(1, profile.steps), 0, 'f', 1);
+        }
+    }
+
+    return report;
+}
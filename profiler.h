@@ -0,0 +1,64 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "symboltable.h"
+#include "triad.h"
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+// Счётчики выполнения триад программы. Позиции триад и номера циклов
+// относятся к свёрнутым триадам той программы, листинг которой дал key.
+struct TriadProfile {
+    QByteArray key;
+    QVector<qint64> triadCounts;   // По позиции триады
+    QVector<qint64> loopCounts;    // Число итераций по номеру цикла
+    qint64 steps;                  // Всего выполнено триад
+    qint64 iterations;             // Всего итераций циклов (переходов по for)
+    bool complete;                 // Программа завершилась, а не исчерпала бюджет
+
+    TriadProfile() : steps(0), iterations(0), complete(false) {}
+
+    bool isEmpty() const { return key.isEmpty(); }
+
+    bool save(const QString &fileName) const;
+    bool load(const QString &fileName);
+
+    static QByteArray programKey(const QVector<Triad> &triads);
+};
+
+// Интерпретатор триад по графу потока управления. Выполнение ограничено
+// бюджетом триад: шаг цикла (++/--) триад не порождает, и циклы программ
+// обычно бесконечны.
+class TriadInterpreter {
+public:
+    static const qint64 DefaultBudget = 1000000;
+
+    TriadInterpreter(const QVector<Triad> &triads, const QVector<TriadLoop> &loops, const SymbolTable &symbols);
+
+    // iterationLimit >= 0 останавливает выполнение после заданного числа итераций циклов
+    TriadProfile run(qint64 budget = DefaultBudget, qint64 iterationLimit = -1) const;
+
+private:
+    struct Value {
+        bool isNumber;
+        qlonglong number;
+        QString text;
+
+        Value() : isNumber(true), number(0) {}
+    };
+
+    const QVector<Triad> &triads;
+    const QVector<TriadLoop> &loops;
+    const SymbolTable &symbols;
+
+    Value operand(const QString &text, int reference, int symbol, const QVector<Value> &variables,
+                  const QVector<Value> &results, const QVector<int> &positionOf) const;
+    static bool compare(TriadOp op, const Value &left, const Value &right);
+};
+
+// Отчёт о горячих местах программы по профилю
+QStringList profileReport(const TriadProfile &profile, const QVector<Triad> &triads, const QVector<TriadLoop> &loops);
+
+#endif // PROFILER_H
@@ -0,0 +1,512 @@
+#include "ssa.h"
+
+namespace {
+
+struct ExpressionKey {
+    int op;
+    qint64 left;
+    qint64 right;
+
+    bool operator==(const ExpressionKey &other) const {
+        return op == other.op && left == other.left && right == other.right;
+    }
+};
+
+inline uint qHash(const ExpressionKey &key, uint seed = 0)
+{
+    return ::qHash(key.left, seed) ^ (::qHash(key.right, seed) * 31u) ^ uint(key.op);
+}
+
+bool isComputation(SsaOp op)
+{
+    return op == SsaAdd || op == SsaSubtract || op == SsaLess || op == SsaGreater || op == SsaEqual;
+}
+
+}
+
+SsaForm::SsaForm(const QVector<Triad> &triads, const QVector<TriadLoop> &loops, const SymbolTable &symbols)
+    : triads(triads), symbols(symbols), cfg(triads, loops)
+{
+    const int symbolCount = symbols.size() + 1;
+
+    blockValueList.resize(cfg.blocks().size());
+    triadValue.fill(-1, triads.size());
+    undefinedValue.fill(-1, symbolCount);
+    stringConstant.fill(-1, symbolCount);
+
+    triadOps.reserve(triads.size());
+    for (const Triad &triad : triads) {
+        triadOps.append(operation(triad.op));
+    }
+
+    placePhis();
+    rename();
+}
+
+SsaOp SsaForm::operation(TriadOp op)
+{
+    switch (op) {
+    case TriadAssign:
+        return SsaCopy;
+    case TriadAdd:
+        return SsaAdd;
+    case TriadSubtract:
+        return SsaSubtract;
+    case TriadLess:
+        return SsaLess;
+    case TriadGreater:
+        return SsaGreater;
+    case TriadEqual:
+        return SsaEqual;
+    case TriadFor:
+        return SsaBranch;
+    default:
+        return SsaOpaque;
+    }
+}
+
+int SsaForm::addValue(const SsaValue &value)
+{
+    valueList.append(value);
+    return valueList.size() - 1;
+}
+
+void SsaForm::placePhis()
+{
+    const QVector<BasicBlock> &blocks = cfg.blocks();
+    const int symbolCount = symbols.size() + 1;
+
+    QVector<QVector<int> > definitions(symbolCount);
+    for (int block = 0; block < blocks.size(); ++block) {
+        for (int position : blocks[block].triads) {
+            SsaOp op = triadOps[position];
+            int variable = triads[position].symbol1;
+            if ((op == SsaCopy || op == SsaAdd || op == SsaSubtract) && variable > 0 &&
+                (definitions[variable].isEmpty() || definitions[variable].last() != block)) {
+                definitions[variable].append(block);
+            }
+        }
+    }
+
+    // Итерированная граница доминирования; отметки хранят номер переменной,
+    // поэтому массивы не очищаются между переменными
+    const QVector<QVector<int> > frontiers = cfg.dominanceFrontiers();
+    QVector<int> hasPhi(blocks.size(), 0);
+    QVector<int> queued(blocks.size(), 0);
+    QVector<int> worklist;
+
+    for (int variable = 1; variable < symbolCount; ++variable) {
+        if (definitions[variable].isEmpty()) {
+            continue;
+        }
+
+        worklist = definitions[variable];
+        for (int block : worklist) {
+            queued[block] = variable;
+        }
+
+        while (!worklist.isEmpty()) {
+            int block = worklist.takeLast();
+            for (int frontier : frontiers[block]) {
+                if (hasPhi[frontier] == variable) {
+                    continue;
+                }
+                hasPhi[frontier] = variable;
+
+                SsaValue phi;
+                phi.op = SsaPhi;
+                phi.block = frontier;
+                phi.variable = variable;
+                phi.operands.fill(-1, blocks[frontier].predecessors.size());
+                blockValueList[frontier].append(addValue(phi));
+
+                if (queued[frontier] != variable) {
+                    queued[frontier] = variable;
+                    worklist.append(frontier);
+                }
+            }
+        }
+    }
+}
+
+void SsaForm::rename()
+{
+    struct Frame {
+        int block;
+        int child;
+        QVector<int> pushed;
+    };
+
+    stacks.fill(QVector<int>(), symbols.size() + 1);
+    versions.fill(0, symbols.size() + 1);
+
+    // Обход дерева доминаторов без рекурсии: глубина дерева растёт с длиной программы
+    QVector<Frame> frames;
+    frames.append(Frame{cfg.entry(), 0, QVector<int>()});
+    renameBlock(cfg.entry(), frames.last().pushed);
+
+    while (!frames.isEmpty()) {
+        const int block = frames.last().block;
+        const int next = frames.last().child++;
+        const QVector<int> &children = cfg.dominatorChildren(block);
+
+        if (next < children.size()) {
+            const int child = children[next];
+            frames.append(Frame{child, 0, QVector<int>()});
+            renameBlock(child, frames.last().pushed);
+        } else {
+            const QVector<int> &pushed = frames.last().pushed;
+            for (int i = pushed.size() - 1; i >= 0; --i) {
+                stacks[pushed[i]].removeLast();
+            }
+            frames.removeLast();
+        }
+    }
+
+    stacks.clear();
+    versions.clear();
+}
+
+void SsaForm::renameBlock(int block, QVector<int> &pushed)
+{
+    const BasicBlock &basicBlock = cfg.blocks()[block];
+
+    for (int value : blockValueList[block]) {
+        SsaValue &phi = valueList[value];
+        phi.version = ++versions[phi.variable];
+        stacks[phi.variable].append(value);
+        pushed.append(phi.variable);
+    }
+
+    for (int position : basicBlock.triads) {
+        const Triad &triad = triads[position];
+
+        SsaValue value;
+        value.op = triadOps[position];
+        value.block = block;
+        value.triad = position;
+
+        int defined = 0;
+        switch (value.op) {
+        case SsaCopy:
+            value.operands.append(operandValue(triad.operand2, triad.symbol2));
+            defined = triad.symbol1;
+            break;
+        case SsaAdd:
+        case SsaSubtract:
+            value.operands.append(operandValue(triad.operand1, triad.symbol1));
+            value.operands.append(operandValue(triad.operand2, triad.symbol2));
+            defined = triad.symbol1;
+            break;
+        case SsaLess:
+        case SsaGreater:
+        case SsaEqual:
+            value.operands.append(operandValue(triad.operand1, triad.symbol1));
+            value.operands.append(operandValue(triad.operand2, triad.symbol2));
+            break;
+        case SsaBranch: {
+            int condition = loopCondition(block);
+            if (condition >= 0 && triadValue[condition] >= 0) {
+                value.operands.append(triadValue[condition]);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+
+        if (defined > 0 && symbols.kind(defined) == VariableSymbol) {
+            value.variable = defined;
+            value.version = ++versions[defined];
+        }
+
+        int id = addValue(value);
+        triadValue[position] = id;
+        blockValueList[block].append(id);
+
+        if (value.variable) {
+            stacks[value.variable].append(id);
+            pushed.append(value.variable);
+        }
+    }
+
+    for (int successor : basicBlock.successors) {
+        const int predecessorIndex = cfg.blocks()[successor].predecessors.indexOf(block);
+        for (int value : blockValueList[successor]) {
+            if (valueList[value].op != SsaPhi) {
+                break;
+            }
+            const int variable = valueList[value].variable;
+            const int operand = operandValue(symbols.name(variable), variable);
+            valueList[value].operands[predecessorIndex] = operand;
+        }
+    }
+}
+
+int SsaForm::operandValue(const QString &operand, int symbol)
+{
+    if (symbol > 0) {
+        if (symbols.kind(symbol) == StringSymbol) {
+            if (stringConstant[symbol] < 0) {
+                SsaValue constant;
+                constant.op = SsaConstant;
+                constant.literal = operand;
+                stringConstant[symbol] = addValue(constant);
+            }
+            return stringConstant[symbol];
+        }
+
+        if (!stacks[symbol].isEmpty()) {
+            return stacks[symbol].last();
+        }
+        if (undefinedValue[symbol] < 0) {
+            SsaValue undefined;
+            undefined.op = SsaUndefined;
+            undefined.variable = symbol;
+            undefinedValue[symbol] = addValue(undefined);
+        }
+        return undefinedValue[symbol];
+    }
+
+    bool isNumber = false;
+    qlonglong number = operand.toLongLong(&isNumber);
+    if (isNumber) {
+        QHash<qlonglong, int>::const_iterator it = numberConstant.constFind(number);
+        if (it != numberConstant.constEnd()) {
+            return it.value();
+        }
+    }
+
+    SsaValue constant;
+    constant.op = SsaConstant;
+    constant.literal = operand;
+    int id = addValue(constant);
+    if (isNumber) {
+        numberConstant.insert(number, id);
+    }
+    return id;
+}
+
+int SsaForm::loopCondition(int latch) const
+{
+    for (int successor : cfg.blocks()[latch].successors) {
+        const BasicBlock &header = cfg.blocks()[successor];
+        if (header.loopHeader && cfg.dominates(successor, latch) && !header.triads.isEmpty()) {
+            return header.triads.first();
+        }
+    }
+    return -1;
+}
+
+void SsaForm::numberValues()
+{
+    QHash<ExpressionKey, int> expressions;
+    QHash<qlonglong, int> integerNumbers;
+    QVector<bool> numberIsInteger;
+    QVector<qlonglong> numberValue;
+    QVector<int> leaders;
+
+    auto newNumber = [&]() -> int {
+        numberIsInteger.append(false);
+        numberValue.append(0);
+        leaders.append(-1);
+        return numberIsInteger.size() - 1;
+    };
+    auto integerNumber = [&](qlonglong value) -> int {
+        QHash<qlonglong, int>::const_iterator it = integerNumbers.constFind(value);
+        if (it != integerNumbers.constEnd()) {
+            return it.value();
+        }
+        int number = newNumber();
+        numberIsInteger[number] = true;
+        numberValue[number] = value;
+        integerNumbers.insert(value, number);
+        return number;
+    };
+
+    for (SsaValue &value : valueList) {
+        value.valueNumber = -1;
+        value.leader = -1;
+        if (isComputation(value.op)) {
+            value.literal.clear();
+        }
+        if (value.op == SsaConstant) {
+            bool isNumber = false;
+            qlonglong number = value.literal.toLongLong(&isNumber);
+            value.valueNumber = isNumber ? integerNumber(number) : newNumber();
+        } else if (value.op == SsaUndefined) {
+            value.valueNumber = newNumber();
+        }
+    }
+
+    // Обратный постпорядок: операнды, кроме приходящих по обратным дугам, уже пронумерованы
+    for (int block : cfg.reversePostorder()) {
+        for (int id : blockValueList[block]) {
+            SsaValue &value = valueList[id];
+
+            if (value.op == SsaPhi) {
+                int same = -1;
+                bool congruent = true;
+                for (int operand : value.operands) {
+                    int number = operand >= 0 ? valueList[operand].valueNumber : -1;
+                    if (number < 0 || (same >= 0 && number != same)) {
+                        congruent = false;
+                        break;
+                    }
+                    same = number;
+                }
+                value.valueNumber = congruent && same >= 0 ? same : newNumber();
+                continue;
+            }
+
+            if (value.op == SsaCopy) {
+                value.valueNumber = value.operands.isEmpty() ? newNumber() : valueList[value.operands[0]].valueNumber;
+                continue;
+            }
+
+            if (!isComputation(value.op) || value.operands.size() != 2) {
+                value.valueNumber = newNumber();
+                continue;
+            }
+
+            int left = valueList[value.operands[0]].valueNumber;
+            int right = valueList[value.operands[1]].valueNumber;
+
+            if (numberIsInteger[left] && numberIsInteger[right]) {
+                qlonglong a = numberValue[left];
+                qlonglong b = numberValue[right];
+                qlonglong folded = 0;
+                switch (value.op) {
+                case SsaAdd:
+                    folded = a + b;
+                    break;
+                case SsaSubtract:
+                    folded = a - b;
+                    break;
+                case SsaLess:
+                    folded = a < b;
+                    break;
+                case SsaGreater:
+                    folded = a > b;
+                    break;
+                default:
+                    folded = a == b;
+                    break;
+                }
+                value.valueNumber = integerNumber(folded);
+                value.literal = QString::number(folded);
+                continue;
+            }
+
+            if (value.op == SsaEqual && right < left) {
+                qSwap(left, right);
+            }
+
+            ExpressionKey key = {value.op, left, right};
+            QHash<ExpressionKey, int>::const_iterator it = expressions.constFind(key);
+            if (it != expressions.constEnd()) {
+                value.valueNumber = it.value();
+            } else {
+                value.valueNumber = newNumber();
+                expressions.insert(key, value.valueNumber);
+            }
+
+            int leader = leaders[value.valueNumber];
+            if (leader < 0) {
+                leaders[value.valueNumber] = id;
+            } else if (cfg.dominates(valueList[leader].block, block)) {
+                value.leader = leader;
+            }
+        }
+    }
+}
+
+QString SsaForm::valueName(int value) const
+{
+    if (value < 0) {
+        return "?";
+    }
+
+    const SsaValue &ssa = valueList[value];
+    if (ssa.op == SsaConstant) {
+        return ssa.literal;
+    }
+    if (ssa.variable) {
+        return QString("%1_%2").arg(symbols.name(ssa.variable)).arg(ssa.version);
+    }
+    if (ssa.triad >= 0) {
+        return QString("^%1").arg(triads[ssa.triad].index);
+    }
+    return "?";
+}
+
+QStringList SsaForm::listing() const
+{
+    QStringList lines;
+    const QVector<BasicBlock> &blocks = cfg.blocks();
+
+    for (int block = 0; block < blocks.size(); ++block) {
+        const BasicBlock &basicBlock = blocks[block];
+
+        QStringList predecessors;
+        for (int predecessor : basicBlock.predecessors) {
+            predecessors << QString("B%1").arg(predecessor);
+        }
+        QStringList successors;
+        for (int successor : basicBlock.successors) {
+            successors << QString("B%1").arg(successor);
+        }
+
+        QString header = QString("B%1").arg(block);
+        if (basicBlock.loopHeader) {
+            header += " (заголовок цикла)";
+        }
+        if (!predecessors.isEmpty()) {
+            header += "  ← " + predecessors.join(", ");
+        }
+        if (!successors.isEmpty()) {
+            header += "  → " + successors.join(", ");
+        }
+        lines << header;
+
+        for (int id : blockValueList[block]) {
+            const SsaValue &value = valueList[id];
+
+            QStringList operands;
+            for (int operand : value.operands) {
+                operands << valueName(operand);
+            }
+
+            QString line;
+            if (value.op == SsaPhi) {
+                line = QString("    %1 = φ(%2)").arg(valueName(id), operands.join(", "));
+            } else {
+                const Triad &triad = triads[value.triad];
+                QString text = value.op == SsaCopy ? operands.value(0)
+                                                   : QString("%1 [%2]").arg(triad.operation(), operands.join(", "));
+                line = value.variable ? QString("    ^%1: %2 := %3").arg(triad.index).arg(valueName(id), text)
+                                      : QString("    ^%1: %2").arg(triad.index).arg(text);
+            }
+
+            if (value.valueNumber >= 0) {
+                line += QString("    #%1").arg(value.valueNumber);
+            }
+            if (isComputation(value.op) && !value.literal.isEmpty()) {
+                line += QString("  = %1").arg(value.literal);
+            } else if (value.leader >= 0) {
+                line += QString("  ≡ ^%1").arg(triads[valueList[value.leader].triad].index);
+            }
+            lines << line;
+        }
+    }
+
+    QStringList backEdges;
+    for (const QPair<int, int> &edge : cfg.backEdges()) {
+        backEdges << QString("B%1 → B%2").arg(edge.first).arg(edge.second);
+    }
+    if (!backEdges.isEmpty()) {
+        lines << QString("Обратные дуги: %1").arg(backEdges.join(", "));
+    }
+
+    return lines;
+}
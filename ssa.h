@@ -0,0 +1,79 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include "cfg.h"
+#include "symboltable.h"
+#include "triad.h"
+
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+enum SsaOp {
+    SsaUndefined,      // Значение переменной на входе в программу
+    SsaConstant,
+    SsaPhi,
+    SsaCopy,           // :=
+    SsaAdd,            // ++
+    SsaSubtract,       // --
+    SsaLess,
+    SsaGreater,
+    SsaEqual,
+    SsaBranch,         // for
+    SsaOpaque
+};
+
+struct SsaValue {
+    SsaOp op;
+    int block;
+    int triad;                 // Позиция триады или -1
+    int variable;              // Определяемая переменная (символ) или 0
+    int version;
+    QVector<int> operands;     // Номера значений; у φ — по предшественникам блока
+    QString literal;           // Текст константы или результат свёртки
+    int valueNumber;
+    int leader;                // Ранее вычисленное равное значение, доминирующее над этим, или -1
+
+    SsaValue() : op(SsaOpaque), block(0), triad(-1), variable(0), version(0), valueNumber(-1), leader(-1) {}
+};
+
+// SSA-форма триад поверх графа потока управления и глобальная нумерация значений
+class SsaForm {
+public:
+    SsaForm(const QVector<Triad> &triads, const QVector<TriadLoop> &loops, const SymbolTable &symbols);
+
+    const ControlFlowGraph &graph() const { return cfg; }
+    const QVector<SsaValue> &values() const { return valueList; }
+    const QVector<int> &blockValues(int block) const { return blockValueList[block]; }
+
+    void numberValues();
+    QStringList listing() const;
+
+private:
+    QVector<Triad> triads;
+    SymbolTable symbols;
+    ControlFlowGraph cfg;
+
+    QVector<SsaValue> valueList;
+    QVector<QVector<int> > blockValueList;   // Сначала φ, затем триады блока
+    QVector<SsaOp> triadOps;
+    QVector<int> triadValue;                 // Значение, вычисляемое триадой в данной позиции
+    QVector<int> undefinedValue;             // По символу
+    QVector<int> stringConstant;             // По символу
+    QHash<qlonglong, int> numberConstant;
+
+    QVector<QVector<int> > stacks;           // Текущие версии переменных при переименовании
+    QVector<int> versions;
+
+    int addValue(const SsaValue &value);
+    void placePhis();
+    void rename();
+    void renameBlock(int block, QVector<int> &pushed);
+    int operandValue(const QString &operand, int symbol);
+    int loopCondition(int latch) const;
+    static SsaOp operation(TriadOp op);
+
+    QString valueName(int value) const;
+};
+
+#endif // SSA_H
@@ -0,0 +1,50 @@
+#include "symboltable.h"
+
+SymbolTable::SymbolTable()
+{
+    clear();
+}
+
+int SymbolTable::intern(const QString &name, SymbolKind kind)
+{
+    QHash<QString, int>::const_iterator it = ids.constFind(name);
+    if (it != ids.constEnd()) {
+        return it.value();
+    }
+
+    int id = names.size();
+    ids.insert(name, id);
+    names.append(name);
+    kinds.append(kind);
+    return id;
+}
+
+void SymbolTable::clear()
+{
+    ids.clear();
+    names.clear();
+    kinds.clear();
+    names.append(QString());
+    kinds.append(VariableSymbol);
+}
+
+const QString *SymbolTable::keyword(const QChar *data, int length)
+{
+    // (длина + первая буква) & 3 различает "for" (1) и "do" (2)
+    static const QString keywords[4] = {QString(), "for", "do", QString()};
+
+    if (length < 2 || length > 3) {
+        return nullptr;
+    }
+
+    const QString &candidate = keywords[(length + data[0].unicode()) & 3];
+    if (candidate.length() != length) {
+        return nullptr;
+    }
+    for (int i = 0; i < length; ++i) {
+        if (candidate[i] != data[i]) {
+            return nullptr;
+        }
+    }
+    return &candidate;
+}
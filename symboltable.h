@@ -0,0 +1,36 @@
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+enum SymbolKind {
+    VariableSymbol,    // Идентификатор
+    StringSymbol       // Строковая константа
+};
+
+// Таблица имён: каждому идентификатору и строковой константе при лексическом
+// анализе выдаётся плотный номер 1..size(). Номер 0 означает «не символ»
+// (число, ссылка на триаду), поэтому массивы по номерам имеют размер size() + 1.
+class SymbolTable {
+public:
+    SymbolTable();
+
+    int intern(const QString &name, SymbolKind kind);
+    void clear();
+
+    const QString &name(int id) const { return names[id]; }
+    SymbolKind kind(int id) const { return kinds[id]; }
+    int size() const { return names.size() - 1; }
+
+    // Ключевые слова распознаются совершенной хеш-функцией без обращения к таблице
+    static const QString *keyword(const QChar *data, int length);
+
+private:
+    QHash<QString, int> ids;
+    QVector<QString> names;
+    QVector<SymbolKind> kinds;
+};
+
+#endif // SYMBOLTABLE_H
@@ -12,7 +12,8 @@ enum TokenType {
     Comparison,        // Оператор сравнения
     Assignment,        // Знак присваивания
     SpecialChar,       // Специальный символ
-    Error              // Ошибка
+    Error,             // Ошибка
+    EndOfText          // Конец текста: лексема, которую поток выдаёт за последней
 };
 
 struct Token {
@@ -20,21 +21,62 @@ struct Token {
     QString value;
     int line;
     int column;
+    int symbol;        // Номер в таблице имён (0 — не символ)
 
     Token() {
         value = "";
         clear();
     }
 
-    Token(TokenType type, const QString& value, int line, int column)
-        : type(type), value(value), line(line), column(column) {}
+    Token(TokenType type, const QString& value, int line, int column, int symbol = 0)
+        : type(type), value(value), line(line), column(column), symbol(symbol) {}
+
+    // Пустая лексема (Token()): например, синтаксической ошибки не было
+    bool isNull() const {
+        return type == Error && line == 0;
+    }
+
+    bool operator==(const Token& other) const {
+        return type == other.type && value == other.value && line == other.line && column == other.column;
+    }
 
     void clear() {
         this->type = Error;
         this->value.clear();
         this->line = 0;
         this->column = 0;
+        this->symbol = 0;
     }
 };
 
+// Длина лексемы в исходном тексте: у ошибочной лексемы в value сообщение, а в тексте — один символ
+inline int tokenLength(const Token &token) {
+    return token.type == Error ? 1 : qMax(1, token.value.length());
+}
+
+inline QString tokenTypeName(TokenType type) {
+    switch (type) {
+    case Identifier:
+        return "Идентификатор";
+    case Keyword:
+        return "Ключевое слово";
+    case Number:
+        return "Число";
+    case StringConstant:
+        return "Строковая константа";
+    case Operator:
+        return "Арифметический оператор";
+    case Comparison:
+        return "Оператор сравнения";
+    case Assignment:
+        return "Знак присваивания";
+    case SpecialChar:
+        return "Специальный символ";
+    case EndOfText:
+        return "Конец текста";
+    default:
+        return "Error";
+    }
+}
+
 #endif // TOKEN_H
@@ -0,0 +1,146 @@
+#include "tokenhighlighter.h"
+
+#include <QTextBlock>
+#include <QTextDocument>
+
+namespace {
+
+// Номер набора лексем, по которому раскрашен блок
+class HighlightData : public QTextBlockUserData
+{
+public:
+    explicit HighlightData(int generation) : generation(generation) {}
+
+    int generation;
+};
+
+int blockGeneration(const QTextBlock &block)
+{
+    const HighlightData *data = static_cast<const HighlightData *>(block.userData());
+    return data ? data->generation : -1;
+}
+
+}
+
+TokenHighlighter::TokenHighlighter(QPlainTextEdit *editor)
+    : QSyntaxHighlighter(editor->document()), editor(editor), generation(0), firstVisible(0), lastVisible(-1),
+      forceHighlight(false)
+{
+    formats[Keyword].setForeground(Qt::darkBlue);
+    formats[Keyword].setFontWeight(QFont::Bold);
+    formats[Number].setForeground(Qt::darkMagenta);
+    formats[StringConstant].setForeground(Qt::darkGreen);
+    formats[Operator].setForeground(Qt::darkRed);
+    formats[Comparison].setForeground(Qt::darkRed);
+    formats[Assignment].setForeground(Qt::darkRed);
+    formats[SpecialChar].setForeground(Qt::darkGray);
+    formats[Error].setUnderlineStyle(QTextCharFormat::WaveUnderline);
+    formats[Error].setUnderlineColor(Qt::red);
+    formats[Error].setForeground(Qt::red);
+
+    syntaxErrorFormat.setBackground(QColor(255, 200, 200));
+    syntaxErrorFormat.setUnderlineStyle(QTextCharFormat::WaveUnderline);
+    syntaxErrorFormat.setUnderlineColor(Qt::red);
+
+    // Перерисовка приходит и при прокрутке, и после вставки очередной части текста
+    connect(editor, &QPlainTextEdit::updateRequest, this, &TokenHighlighter::highlightVisible);
+}
+
+void TokenHighlighter::setTokens(const QList<Token> &tokens)
+{
+    this->tokens = tokens;
+
+    int lastLine = tokens.isEmpty() ? 0 : tokens.last().line;
+    lineStart.fill(0, lastLine + 2);
+
+    int line = 0;
+    for (int i = 0; i < tokens.size(); ++i) {
+        while (line < tokens[i].line) {
+            lineStart[++line] = i;
+        }
+    }
+    while (line < lastLine + 1) {
+        lineStart[++line] = tokens.size();
+    }
+
+    // Остальные блоки устаревают и перекрашиваются, когда станут видимыми
+    generation++;
+    highlightVisible();
+}
+
+void TokenHighlighter::setSyntaxError(const Token &error)
+{
+    int previousLine = syntaxError.line;
+    syntaxError = error;
+
+    rehighlightLine(previousLine);
+    if (error.line != previousLine) {
+        rehighlightLine(error.line);
+    }
+}
+
+void TokenHighlighter::rehighlightLine(int line)
+{
+    if (line < 1 || !document()) {
+        return;
+    }
+
+    QTextBlock block = document()->findBlockByNumber(line - 1);
+    if (block.isValid()) {
+        forceHighlight = true;
+        rehighlightBlock(block);
+        forceHighlight = false;
+    }
+}
+
+void TokenHighlighter::highlightVisible()
+{
+    QTextBlock block = editor->cursorForPosition(QPoint(0, 0)).block();
+    if (!block.isValid()) {
+        return;
+    }
+
+    firstVisible = block.blockNumber();
+    lastVisible = editor->cursorForPosition(QPoint(0, editor->viewport()->height() - 1)).blockNumber();
+
+    forceHighlight = true;
+    for (; block.isValid() && block.blockNumber() <= lastVisible; block = block.next()) {
+        if (blockGeneration(block) != generation) {
+            rehighlightBlock(block);
+        }
+    }
+    forceHighlight = false;
+}
+
+void TokenHighlighter::highlightBlock(const QString &text)
+{
+    const int number = currentBlock().blockNumber();
+
+    // Невидимый блок (например, только что вставленный в конец) остаётся без подсветки до прокрутки к нему
+    HighlightData *data = static_cast<HighlightData *>(currentBlockUserData());
+    if (!forceHighlight && (number < firstVisible || number > lastVisible)) {
+        if (data) {
+            data->generation = -1;
+        }
+        return;
+    }
+    if (data) {
+        data->generation = generation;
+    } else {
+        setCurrentBlockUserData(new HighlightData(generation));
+    }
+
+    const int line = number + 1;
+    if (line + 1 >= lineStart.size()) {
+        return;
+    }
+
+    for (int i = lineStart[line]; i < lineStart[line + 1]; ++i) {
+        const Token &token = tokens[i];
+        setFormat(token.column - 1, qMin(tokenLength(token), text.length() - token.column + 1), formats[token.type]);
+    }
+
+    if (syntaxError.line == line && syntaxError.column > 0) {
+        setFormat(syntaxError.column - 1, tokenLength(syntaxError), syntaxErrorFormat);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef TOKENHIGHLIGHTER_H
+#define TOKENHIGHLIGHTER_H
+
+#include "token.h"
+
+#include <QList>
+#include <QPlainTextEdit>
+#include <QSyntaxHighlighter>
+#include <QTextCharFormat>
+#include <QVector>
+
+// Подсветка по уже построенному списку лексем: строка документа раскрашивается
+// поиском её лексем по индексу, без повторного лексического анализа.
+// Раскрашиваются только видимые в редакторе строки, остальные — при прокрутке.
+class TokenHighlighter : public QSyntaxHighlighter
+{
+    Q_OBJECT
+
+public:
+    explicit TokenHighlighter(QPlainTextEdit *editor);
+
+    void setTokens(const QList<Token> &tokens);
+    void setSyntaxError(const Token &error);
+
+protected:
+    void highlightBlock(const QString &text) override;
+
+private slots:
+    void highlightVisible();
+
+private:
+    QPlainTextEdit *editor;
+    QList<Token> tokens;
+    QVector<int> lineStart;       // Номер первой лексемы строки; лексемы строки n — [lineStart[n], lineStart[n + 1])
+    Token syntaxError;
+    int generation;               // Номер набора лексем; блок помнит, по какому набору он раскрашен
+    int firstVisible;             // Видимые номера блоков на момент последней перерисовки
+    int lastVisible;
+    bool forceHighlight;
+
+    QTextCharFormat formats[Error + 1];
+    QTextCharFormat syntaxErrorFormat;
+
+    void rehighlightLine(int line);
+};
+
+#endif // TOKENHIGHLIGHTER_H
@@ -0,0 +1,25 @@
+#include "tokenstream.h"
+
+LexerTokenStream::LexerTokenStream(Lexer &lexer)
+    : lexer(lexer), ring(Capacity), produced(0), finished(false)
+{
+}
+
+bool LexerTokenStream::has(int index)
+{
+    Q_ASSERT(index > produced - Capacity);
+
+    while (!finished && produced <= index) {
+        if (lexer.next(ring[produced % Capacity])) {
+            produced++;
+        } else {
+            finished = true;
+        }
+    }
+    return index < produced;
+}
+
+const Token &LexerTokenStream::operator[](int index)
+{
+    return has(index) ? ring[index % Capacity] : endToken();
+}
@@ -0,0 +1,58 @@
+#ifndef TOKENSTREAM_H
+#define TOKENSTREAM_H
+
+#include "lexer.h"
+#include "token.h"
+
+#include <QList>
+#include <QVector>
+
+// Источник лексем для синтаксического анализатора. Анализатор обращается
+// к лексемам по номеру и заглядывает вперёд не больше чем на несколько позиций.
+class TokenStream {
+public:
+    virtual ~TokenStream() {}
+
+    virtual bool has(int index) = 0;
+    virtual const Token &operator[](int index) = 0;
+
+protected:
+    static const Token &endToken() {
+        static const Token token(EndOfText, QString(), 0, 0);
+        return token;
+    }
+};
+
+// Уже построенный список лексем
+class TokenListStream : public TokenStream {
+public:
+    explicit TokenListStream(const QList<Token> &tokens) : tokens(tokens) {}
+
+    bool has(int index) override { return index < tokens.size(); }
+    const Token &operator[](int index) override {
+        return index < tokens.size() ? tokens[index] : endToken();
+    }
+
+private:
+    const QList<Token> &tokens;
+};
+
+// Лексемы по требованию анализатора читаются из Lexer в кольцевой буфер
+// фиксированного размера, так что память не зависит от длины файла
+class LexerTokenStream : public TokenStream {
+public:
+    explicit LexerTokenStream(Lexer &lexer);
+
+    bool has(int index) override;
+    const Token &operator[](int index) override;
+
+private:
+    static const int Capacity = 16;
+
+    Lexer &lexer;
+    QVector<Token> ring;
+    int produced;
+    bool finished;
+};
+
+#endif // TOKENSTREAM_H
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+# Сценарный клиент для проверки режима --lsp.
+#
+#   python3 tools/lsp_client.py путь/к/Translator [аргументы сервера...]
+#
+# Без аргументов сервера запускается "Translator --lsp". Клиент проходит
+# initialize, didOpen/didChange, semanticTokens/full, hover и shutdown/exit,
+# проверяет ответы и завершается с ненулевым кодом при первом расхождении.
+
+import json
+import subprocess
+import sys
+
+URI = 'file:///sample.txt'
+PROGRAM = '// пример\nfor (i := 0; i < 10; i++) do x := 5;\n'
+
+
+class Client:
+    def __init__(self, command):
+        self.process = subprocess.Popen(command, stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+        self.next_id = 1
+
+    def write(self, message, split=False):
+        body = json.dumps(message, ensure_ascii=False).encode('utf-8')
+        header = b'Content-Length: %d\r\n\r\n' % len(body)
+        if split:
+            # Заголовок и тело разными порциями: сервер должен дочитать тело по Content-Length
+            self.process.stdin.write(header)
+            self.process.stdin.flush()
+            self.process.stdin.write(body[:len(body) // 2])
+            self.process.stdin.flush()
+            self.process.stdin.write(body[len(body) // 2:])
+        else:
+            self.process.stdin.write(header + body)
+        self.process.stdin.flush()
+
+    def read(self):
+        length = None
+        while True:
+            line = self.process.stdout.readline()
+            if not line:
+                raise AssertionError('сервер закрыл stdout')
+            line = line.strip()
+            if not line:
+                break
+            name, _, value = line.partition(b':')
+            if name.strip().lower() == b'content-length':
+                length = int(value)
+        check(length is not None, 'нет заголовка Content-Length')
+        body = self.process.stdout.read(length)
+        check(len(body) == length, 'тело короче Content-Length')
+        return json.loads(body.decode('utf-8'))
+
+    def request(self, method, params=None, split=False):
+        message = {'jsonrpc': '2.0', 'id': self.next_id, 'method': method}
+        if params is not None:
+            message['params'] = params
+        self.next_id += 1
+        self.write(message, split)
+        response = self.read()
+        check(response.get('id') == message['id'], 'ответ на чужой запрос: %r' % response)
+        return response
+
+    def notify(self, method, params=None):
+        message = {'jsonrpc': '2.0', 'method': method}
+        if params is not None:
+            message['params'] = params
+        self.write(message)
+
+    def diagnostics(self):
+        message = self.read()
+        check(message.get('method') == 'textDocument/publishDiagnostics', 'ожидалась диагностика: %r' % message)
+        check(message['params']['uri'] == URI, 'диагностика для другого документа')
+        return message['params']['diagnostics']
+
+
+def check(condition, text):
+    if not condition:
+        raise AssertionError(text)
+
+
+def position(line, character):
+    return {'line': line, 'character': character}
+
+
+def change(client, version, start, end, text):
+    client.notify('textDocument/didChange', {
+        'textDocument': {'uri': URI, 'version': version},
+        'contentChanges': [{'range': {'start': start, 'end': end}, 'text': text}],
+    })
+    return client.diagnostics()
+
+
+def replace_all(client, version, text):
+    client.notify('textDocument/didChange', {
+        'textDocument': {'uri': URI, 'version': version},
+        'contentChanges': [{'text': text}],
+    })
+    return client.diagnostics()
+
+
+def run(client):
+    response = client.request('initialize', {'processId': None, 'rootUri': None, 'capabilities': {}}, split=True)
+    capabilities = response['result']['capabilities']
+    check(capabilities['textDocumentSync']['change'] == 2, 'ожидалась инкрементальная синхронизация')
+    check(capabilities['hoverProvider'], 'нет hoverProvider')
+    legend = capabilities['semanticTokensProvider']['legend']['tokenTypes']
+    client.notify('initialized', {})
+    print('initialize: ok')
+
+    client.notify('textDocument/didOpen', {
+        'textDocument': {'uri': URI, 'languageId': 'translator', 'version': 1, 'text': PROGRAM},
+    })
+    check(client.diagnostics() == [], 'корректная программа дала диагностику')
+    print('didOpen: ok')
+
+    data = client.request('textDocument/semanticTokens/full', {'textDocument': {'uri': URI}})['result']['data']
+    check(len(data) % 5 == 0 and data, 'неверный формат semantic tokens')
+    # Первая лексема — ключевое слово for во второй строке
+    check(data[:4] == [1, 0, 3, legend.index('keyword')], 'первая лексема: %r' % data[:5])
+    print('semanticTokens: ok (%d лексем)' % (len(data) // 5))
+
+    x = PROGRAM.split('\n')[1].index('x :=')
+    hover = client.request('textDocument/hover', {'textDocument': {'uri': URI}, 'position': position(1, x)})['result']
+    check(hover and '`x`' in hover['contents']['value'], 'hover над x: %r' % hover)
+    check(hover['range']['start'] == position(1, x), 'диапазон hover: %r' % hover['range'])
+    print('hover: ok')
+
+    # Неопознанный символ в начале текста и его удаление
+    diagnostics = change(client, 2, position(0, 0), position(0, 0), '@')
+    check(len(diagnostics) == 1 and diagnostics[0]['range']['start'] == position(0, 0), 'после вставки @: %r' % diagnostics)
+    check(change(client, 3, position(0, 0), position(0, 1), '') == [], 'после удаления @ осталась диагностика')
+    print('didChange: ok')
+
+    # Лишние лексемы после программы — ошибка на первой из них, а не конец текста
+    diagnostics = replace_all(client, 4, 'x := 1; ;')
+    check(len(diagnostics) == 1, 'лишняя лексема: %r' % diagnostics)
+    check(diagnostics[0]['range']['start'] == position(0, 8), 'место лишней лексемы: %r' % diagnostics)
+    check('конец текста' not in diagnostics[0]['message'], 'лишняя лексема названа концом текста')
+
+    diagnostics = replace_all(client, 5, 'x := 1')
+    check(len(diagnostics) == 1 and 'конец текста' in diagnostics[0]['message'], 'незаконченная программа: %r' % diagnostics)
+    print('trailing tokens / end of text: ok')
+
+    response = client.request('textDocument/definition', {'textDocument': {'uri': URI}, 'position': position(0, 0)})
+    check(response.get('error', {}).get('code') == -32601, 'неизвестный метод: %r' % response)
+
+    # При закрытии сервер снимает диагностику документа
+    client.notify('textDocument/didClose', {'textDocument': {'uri': URI}})
+    check(client.diagnostics() == [], 'после didClose осталась диагностика')
+    response = client.request('shutdown')
+    check('result' in response and response['result'] is None, 'shutdown: %r' % response)
+    client.notify('exit')
+    code = client.process.wait(timeout=10)
+    check(code == 0, 'код завершения сервера %d' % code)
+    print('shutdown/exit: ok')
+
+
+def main():
+    if len(sys.argv) < 2:
+        print('использование: lsp_client.py SERVER [ARGS...]', file=sys.stderr)
+        return 2
+
+    command = sys.argv[1:] if len(sys.argv) > 2 else [sys.argv[1], '--lsp']
+    client = Client(command)
+    try:
+        run(client)
+    except (AssertionError, KeyError, ValueError) as error:
+        print('ОШИБКА: %s' % error, file=sys.stderr)
+        client.process.kill()
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
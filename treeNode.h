@@ -8,11 +8,22 @@ struct TreeNode {
     QString type;
     QString value;
     QVector<TreeNode> children;
+    int symbol;
+
+    TreeNode() : symbol(0) {}
+
+    TreeNode(const QString& type, const QString& value, const QVector<TreeNode>& children, int symbol = 0)
+        : type(type), value(value), children(children), symbol(symbol) {}
+
+    bool operator==(const TreeNode& other) const {
+        return type == other.type && value == other.value && children == other.children;
+    }
 
     void clear() {
         this->type.clear();
         this->value.clear();
         this->children.clear();
+        this->symbol = 0;
     }
 };
 
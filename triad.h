@@ -3,20 +3,56 @@
 
 #include <QString>
 
+enum TriadOp {
+    TriadAssign,       // :=
+    TriadAdd,          // ++
+    TriadSubtract,     // --
+    TriadLess,
+    TriadGreater,
+    TriadEqual,
+    TriadFor,
+    TriadNone
+};
+
 struct Triad {
     int index;
-    QString operation;
-    QString operand1;
+    TriadOp op;
+    QString operand1;      // Имя или число; пусто, если операнд — ссылка на триаду
     QString operand2;
+    int reference1;        // Номер триады-операнда ^N или 0
+    int reference2;
+    int symbol1;
+    int symbol2;
+
+    Triad() : index(0), op(TriadNone), reference1(0), reference2(0), symbol1(0), symbol2(0) {}
+
+    Triad(TriadOp op, const QString& op1, const QString& op2, int sym1 = 0, int sym2 = 0)
+        : index(0), op(op), operand1(op1), operand2(op2), reference1(0), reference2(0), symbol1(sym1), symbol2(sym2) {}
 
-    Triad() : index(0), operation(""), operand1(""), operand2("") {}
+    bool operator==(const Triad& other) const {
+        return index == other.index && op == other.op &&
+               operand1 == other.operand1 && operand2 == other.operand2 &&
+               reference1 == other.reference1 && reference2 == other.reference2;
+    }
 
-    Triad(const QString& op, const QString& op1, const QString& op2)
-        : index(0), operation(op), operand1(op1), operand2(op2) {}
+    QString operation() const {
+        static const char *const names[] = {":=", "+", "-", "<", ">", "=", "for", ""};
+        return QString(names[op]);
+    }
 
     QString toString() const {
-        return QString("%1 [%2, %3]").arg(operation, operand1, operand2);
+        return QString("%1 [%2, %3]").arg(operation(),
+                                          reference1 ? QString("^%1").arg(reference1) : operand1,
+                                          reference2 ? QString("^%1").arg(reference2) : operand2);
     }
 };
 
+// Цикл for в последовательности триад (номера триад)
+struct TriadLoop {
+    int begin;         // Первая триада заголовка for (...)
+    int condition;     // Триада условия
+    int body;          // Первая триада тела; между condition и body — шаг цикла
+    int end;           // Сама триада for
+};
+
 #endif // TRIAD_H
@@ -0,0 +1,79 @@
+#include "workstealingpool.h"
+
+#include <QThread>
+
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(int threads)
+    : threads(threads > 0 ? threads : qMax(1, QThread::idealThreadCount()))
+{
+}
+
+void WorkStealingPool::run(int count, const std::function<void(int)> &task)
+{
+    const int workers = qMax(1, qMin(threads, count));
+    std::vector<Queue> queues(workers);
+    for (int worker = 0; worker < workers; ++worker) {
+        const int from = static_cast<int>(static_cast<qint64>(count) * worker / workers);
+        const int to = static_cast<int>(static_cast<qint64>(count) * (worker + 1) / workers);
+        for (int item = from; item < to; ++item) {
+            queues[worker].items.push_back(item);
+        }
+    }
+
+    // Вызывающий поток работает как нулевой
+    std::vector<std::thread> pool;
+    for (int worker = 1; worker < workers; ++worker) {
+        pool.emplace_back(&WorkStealingPool::work, std::ref(queues), worker, std::cref(task));
+    }
+    work(queues, 0, task);
+
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::work(std::vector<Queue> &queues, int self, const std::function<void(int)> &task)
+{
+    const int workers = static_cast<int>(queues.size());
+    int item;
+    for (;;) {
+        if (pop(queues[self], item)) {
+            task(item);
+            continue;
+        }
+
+        // Новые задания во время работы не появляются, поэтому поток,
+        // не нашедший работы ни в одной очереди, может завершаться
+        bool stolen = false;
+        for (int offset = 1; offset < workers && !stolen; ++offset) {
+            stolen = steal(queues[(self + offset) % workers], item);
+        }
+        if (!stolen) {
+            return;
+        }
+        task(item);
+    }
+}
+
+bool WorkStealingPool::pop(Queue &queue, int &item)
+{
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.items.empty()) {
+        return false;
+    }
+    item = queue.items.back();
+    queue.items.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(Queue &queue, int &item)
+{
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.items.empty()) {
+        return false;
+    }
+    item = queue.items.front();
+    queue.items.pop_front();
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Пул потоков с перехватом работы. Задания делятся между потоками поровну;
+// поток берёт свои задания с конца очереди, а освободившись, забирает
+// чужие с начала, так что неравные по стоимости задания выравниваются сами.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int threads = 0);   // 0 — по числу ядер
+
+    int threadCount() const { return threads; }
+
+    // Выполняет task(0) .. task(count - 1) и возвращается после завершения всех
+    void run(int count, const std::function<void(int)> &task);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<int> items;
+    };
+
+    int threads;
+
+    static void work(std::vector<Queue> &queues, int self, const std::function<void(int)> &task);
+    static bool pop(Queue &queue, int &item);
+    static bool steal(Queue &queue, int &item);
+};
+
+#endif // WORKSTEALINGPOOL_H